@@ -5,3 +5,8 @@ Asset const* AssetHandleBase::GetAsset(std::type_index inType) const
 {
     return mAssetManager ? mAssetManager->Get(inType, mAssetId) : nullptr;
 }
+
+cstr AssetHandleBase::GetAssetName(std::type_index inType) const
+{
+    return mAssetManager ? mAssetManager->GetName(inType, mAssetId) : nullptr;
+}
@@ -21,6 +21,9 @@ class AssetHandleBase
 public:
 	Asset const* GetAsset(std::type_index inType) const;
 
+	// Null for empty handles and unnamed assets, see AssetManager::SetName.
+	cstr GetAssetName(std::type_index inType) const;
+
 protected:
 	AssetHandleBase(AssetManager const* inAssetManager, u32 inAssetId)
 		: mAssetManager(inAssetManager), mAssetId(inAssetId) {}
@@ -42,6 +45,11 @@ public:
 		return (Type const*)(AssetHandleBase::GetAsset(typeid(Type)));
 	}
 
+	cstr GetAssetName() const
+	{
+		return AssetHandleBase::GetAssetName(typeid(Type));
+	}
+
 private:
 	AssetHandle(AssetManager const& inAssetManager, u32 inAssetId)
 		: AssetHandleBase(&inAssetManager, inAssetId) {}
@@ -17,6 +17,30 @@ Asset* AssetManager::AssetList::Get(u32 inAssetId) const
 	return mAssets.contains(inAssetId) ? mAssets.at(inAssetId) : nullptr;
 }
 
+void AssetManager::AssetList::SetName(u32 inAssetId, mage::StringView inName)
+{
+	if (!mage_ensure(mAssets.contains(inAssetId)))
+		return;
+
+	const auto [found, isNew] = mIdsByName.try_emplace(inName.GetCString(), inAssetId);
+	if (!mage_ensure(isNew || found->second == inAssetId))
+		return;
+
+	mNames[inAssetId] = found->first;
+}
+
+cstr AssetManager::AssetList::GetName(u32 inAssetId) const
+{
+	const auto found = mNames.find(inAssetId);
+	return found != mNames.end() ? found->second.c_str() : nullptr;
+}
+
+u32 AssetManager::AssetList::Find(mage::StringView inName) const
+{
+	const auto found = mIdsByName.find(std::string_view(inName.GetCString(), inName.GetLength()));
+	return found != mIdsByName.end() ? found->second : 0;
+}
+
 Asset const* AssetManager::Get(std::type_index inType, u32 inAssetId) const
 {
 	if (mAssetLists.contains(inType))
@@ -24,3 +48,11 @@ Asset const* AssetManager::Get(std::type_index inType, u32 inAssetId) const
 
 	return nullptr;
 }
+
+cstr AssetManager::GetName(std::type_index inType, u32 inAssetId) const
+{
+	if (mAssetLists.contains(inType))
+		return mAssetLists.at(inType).GetName(inAssetId);
+
+	return nullptr;
+}
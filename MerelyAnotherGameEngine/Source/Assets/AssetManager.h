@@ -3,6 +3,7 @@
 #include "Assets/Asset.h"
 
 #include <map>
+#include <string>
 
 class AssetManager : public NonMovableClass
 {
@@ -12,6 +13,29 @@ class AssetManager : public NonMovableClass
 public:
 	Asset const* Get(std::type_index inType, u32 inAssetId) const;
 
+	// Null for assets without a name.
+	cstr GetName(std::type_index inType, u32 inAssetId) const;
+
+	// Snapshots and scene files refer to assets by name, which unlike ids does not depend on the
+	// order assets were loaded in. Assets loaded from a file are named after its path. Names are
+	// unique per asset type.
+	template <AssetType Type>
+	void SetName(AssetHandle<Type> inHandle, mage::StringView inName)
+	{
+		if (mage_ensure(inHandle.mAssetManager == this))
+			mAssetLists[typeid(Type)].SetName(inHandle.mAssetId, inName);
+	}
+
+	// An empty handle when no asset of the type has the name.
+	template <AssetType Type>
+	AssetHandle<Type> FindHandle(mage::StringView inName) const
+	{
+		const auto found = mAssetLists.find(typeid(Type));
+		const u32 assetId = found != mAssetLists.end() ? found->second.Find(inName) : 0;
+
+		return assetId != 0 ? AssetHandle<Type>(*this, assetId) : AssetHandle<Type>();
+	}
+
 private:
 	class AssetList
 	{
@@ -22,8 +46,16 @@ private:
 
 		Asset* Get(u32 inAssetId) const;
 
+		void SetName(u32 inAssetId, mage::StringView inName);
+		cstr GetName(u32 inAssetId) const;
+
+		// Zero when no asset has the name.
+		u32 Find(mage::StringView inName) const;
+
 	private:
 		std::map<u32, Asset*> mAssets;
+		std::map<u32, std::string> mNames;
+		std::map<std::string, u32, std::less<>> mIdsByName;
 		u32 mIdCounter = 0;
 	};
 
@@ -36,5 +68,13 @@ private:
 		return AssetHandle<Type>(*this, mAssetLists[typeid(Type)].Register(inAsset));
 	}
 
+	template <AssetType Type>
+	AssetHandle<Type> Register(Type* inAsset, mage::StringView inName)
+	{
+		AssetHandle<Type> handle = Register(inAsset);
+		SetName(handle, inName);
+		return handle;
+	}
+
 	std::map<std::type_index, AssetList> mAssetLists;
 };
@@ -1,6 +1,6 @@
 #include "Assets/FontFactory.h"
 
-AssetHandle<Font> Factory<Font>::FromFile(mage::StringView inPath, Vulkan::Renderer const& inRenderer, AssetManager& inAssetManager)
+AssetHandle<Font> Factory<Font>::FromFile(mage::StringView inPath, Vulkan::Renderer const* inRenderer, AssetManager& inAssetManager)
 {
 	Font* result = new Font();
 
@@ -467,7 +467,8 @@ AssetHandle<Font> Factory<Font>::FromFile(mage::StringView inPath, Vulkan::Rende
 		}
 	}
 
-	result->CreateGlyphBuffer(inRenderer);
+	if (inRenderer)
+		result->CreateGlyphBuffer(*inRenderer);
 
-	return inAssetManager.Register(result);
+	return inAssetManager.Register(result, inPath);
 }
@@ -12,7 +12,8 @@ template<>
 class Factory<Font>
 {
 public:
-	static AssetHandle<Font> FromFile(mage::StringView inPath, Vulkan::Renderer const& inRenderer, AssetManager& inAssetManager);
+	// Without a renderer the glyphs are parsed but not uploaded.
+	static AssetHandle<Font> FromFile(mage::StringView inPath, Vulkan::Renderer const* inRenderer, AssetManager& inAssetManager);
 
 private:
 	Factory() {}
@@ -36,6 +36,9 @@ public:
 	void Bind(vk::CommandBuffer inCommandBuffer) const;
 	void Draw(vk::CommandBuffer inCommandBuffer) const;
 
+	mage::Array<Vertex> const& GetVertices() const { return mVertices; }
+	mage::Array<Triangle> const& GetFaces() const { return mFaces; }
+
 private:
 	StaticMesh() {}
 
@@ -12,13 +12,14 @@ template<>
 class Factory<StaticMesh>
 {
 public:
-	static AssetHandle<StaticMesh> FromFile(mage::StringView inPath, Vulkan::Renderer const& inRenderer, AssetManager& inAssetManager);
+	// Without a renderer the mesh only keeps its vertices and faces, for headless worlds and collision.
+	static AssetHandle<StaticMesh> FromFile(mage::StringView inPath, Vulkan::Renderer const* inRenderer, AssetManager& inAssetManager);
 
-	static AssetHandle<StaticMesh> MakeBox(glm::vec3 inHalfExtent, Vulkan::Renderer const& inRenderer, AssetManager& inAssetManager);
-	static AssetHandle<StaticMesh> MakeBall(f32 inRadius, Vulkan::Renderer const& inRenderer, AssetManager& inAssetManager);
-	static AssetHandle<StaticMesh> MakeCylinder(f32 inRadius, f32 inHalfHeight, Vulkan::Renderer const& inRenderer, AssetManager& inAssetManager);
-	static AssetHandle<StaticMesh> MakeCapsule(f32 inRadius, f32 inHalfHeight, Vulkan::Renderer const& inRenderer, AssetManager& inAssetManager);
-	static AssetHandle<StaticMesh> MakeCone(f32 inRadius, f32 inHeight, Vulkan::Renderer const& inRenderer, AssetManager& inAssetManager);
+	static AssetHandle<StaticMesh> MakeBox(glm::vec3 inHalfExtent, Vulkan::Renderer const* inRenderer, AssetManager& inAssetManager);
+	static AssetHandle<StaticMesh> MakeBall(f32 inRadius, Vulkan::Renderer const* inRenderer, AssetManager& inAssetManager);
+	static AssetHandle<StaticMesh> MakeCylinder(f32 inRadius, f32 inHalfHeight, Vulkan::Renderer const* inRenderer, AssetManager& inAssetManager);
+	static AssetHandle<StaticMesh> MakeCapsule(f32 inRadius, f32 inHalfHeight, Vulkan::Renderer const* inRenderer, AssetManager& inAssetManager);
+	static AssetHandle<StaticMesh> MakeCone(f32 inRadius, f32 inHeight, Vulkan::Renderer const* inRenderer, AssetManager& inAssetManager);
 
 private:
 	Factory() {}
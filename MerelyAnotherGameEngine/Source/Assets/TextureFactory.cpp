@@ -4,7 +4,7 @@
 
 #include <stb_image.h>
 
-AssetHandle<Texture> Factory<Texture>::FromFile(mage::StringView inPath, Vulkan::Renderer const& inRenderer, AssetManager& inAssetManager)
+AssetHandle<Texture> Factory<Texture>::FromFile(mage::StringView inPath, Vulkan::Renderer const* inRenderer, AssetManager& inAssetManager)
 {
 	Texture* result = new Texture();
 
@@ -20,7 +20,8 @@ AssetHandle<Texture> Factory<Texture>::FromFile(mage::StringView inPath, Vulkan:
 
 	stbi_image_free(imageData);
 
-	result->CreateImage(inRenderer);
+	if (inRenderer)
+		result->CreateImage(*inRenderer);
 
-	return inAssetManager.Register(result);
+	return inAssetManager.Register(result, inPath);
 }
@@ -12,7 +12,8 @@ template<>
 class Factory<Texture>
 {
 public:
-	static AssetHandle<Texture> FromFile(mage::StringView inPath, Vulkan::Renderer const& inRenderer, AssetManager& inAssetManager);
+	// Without a renderer no image is created; headless worlds only need the handle.
+	static AssetHandle<Texture> FromFile(mage::StringView inPath, Vulkan::Renderer const* inRenderer, AssetManager& inAssetManager);
 
 private:
 	Factory() {}
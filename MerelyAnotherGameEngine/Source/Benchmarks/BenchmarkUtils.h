@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+namespace Benchmark
+{
+	// 1, 2, 4, ... up to and including the number of hardware threads.
+	inline mage::Array<u32> GetThreadCounts()
+	{
+		const u32 hardwareThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		mage::Array<u32> threadCounts;
+		for (u32 threadCount = 1; threadCount < hardwareThreadCount; threadCount *= 2)
+			threadCounts.Add(threadCount);
+		threadCounts.Add(hardwareThreadCount);
+
+		return threadCounts;
+	}
+
+	// Best wall time of several runs, which filters out most scheduling noise.
+	template<typename Function>
+	f64 MeasureMilliseconds(u32 repetitions, Function&& function)
+	{
+		f64 bestTime = std::numeric_limits<f64>::max();
+
+		for (u32 i = 0; i < repetitions; ++i)
+		{
+			const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+			function();
+			const std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+
+			bestTime = std::min(bestTime, std::chrono::duration<f64, std::milli>(endTime - startTime).count());
+		}
+
+		return bestTime;
+	}
+
+	// Nearest-rank percentile, in [0, 100], of values sorted in ascending order.
+	inline f64 GetPercentile(mage::Array<f64> const& sortedValues, f64 percentile)
+	{
+		if (sortedValues.IsEmpty())
+			return 0.0;
+
+		const u32 rank = u32(std::ceil(percentile / 100.0 * f64(sortedValues.GetSize())));
+		return sortedValues[std::clamp(rank, 1u, sortedValues.GetSize()) - 1];
+	}
+}
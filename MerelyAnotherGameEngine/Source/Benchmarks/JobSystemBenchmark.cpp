@@ -0,0 +1,92 @@
+#include "Benchmarks/JobSystemBenchmark.h"
+
+#include "Benchmarks/BenchmarkUtils.h"
+#include "Core/JobSystem.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	constexpr u32 cElementCount = 1 << 20;
+	constexpr u32 cSmallJobCount = 1 << 16;
+	constexpr u32 cRepetitions = 5;
+
+	// Enough arithmetic per element that the loop is bound by compute rather than memory.
+	void IntegrateParticle(glm::vec4& particle)
+	{
+		for (u32 i = 0; i < 32; ++i)
+			particle = glm::vec4(glm::sin(particle.y), glm::cos(particle.z), glm::sqrt(glm::abs(particle.w) + 1.0f), particle.x) * 0.99f;
+	}
+}
+
+i32 RunJobSystemBenchmark()
+{
+	mage::Array<glm::vec4> particles;
+	particles.ResizeUninitialized(cElementCount);
+
+	for (u32 i = 0; i < cElementCount; ++i)
+		particles[i] = glm::vec4(f32(i), f32(i) * 0.5f, f32(i) * 0.25f, 1.0f);
+
+	std::cout << "Job system: " << cElementCount << " particles, " << cSmallJobCount << " small jobs, best of " << cRepetitions << " runs" << std::endl;
+	std::cout << std::setw(8) << "threads" << std::setw(16) << "parallel for" << std::setw(10) << "speedup" << std::setw(16) << "small jobs" << std::setw(16) << "dependent" << std::endl;
+
+	f64 singleThreadTime = 0.0;
+
+	for (u32 threadCount : Benchmark::GetThreadCounts())
+	{
+		mage::JobSystem jobSystem({ .ThreadCount = threadCount });
+
+		const f64 parallelForTime = Benchmark::MeasureMilliseconds(cRepetitions, [&]()
+			{
+				jobSystem.ParallelFor(particles, IntegrateParticle);
+			});
+
+		std::atomic<u32> smallJobSum = 0;
+		const f64 smallJobTime = Benchmark::MeasureMilliseconds(cRepetitions, [&]()
+			{
+				mage::JobCounter counter;
+
+				for (u32 i = 0; i < cSmallJobCount; ++i)
+					jobSystem.Schedule([&smallJobSum]() { smallJobSum.fetch_add(1, std::memory_order_relaxed); }, &counter);
+
+				jobSystem.Wait(counter);
+			});
+
+		// Two fan-out stages where the second only starts once the first has finished.
+		const f64 dependentTime = Benchmark::MeasureMilliseconds(cRepetitions, [&]()
+			{
+				constexpr u32 stageJobCount = 64;
+				const u32 stageRange = cElementCount / stageJobCount;
+
+				mage::JobCounter firstStage;
+				mage::JobCounter secondStage;
+
+				for (u32 job = 0; job < stageJobCount; ++job)
+				{
+					auto integrateRange = [&particles, job, stageRange]()
+						{
+							for (u32 i = job * stageRange; i < (job + 1) * stageRange; ++i)
+								IntegrateParticle(particles[i]);
+						};
+
+					jobSystem.Schedule(integrateRange, &firstStage);
+					jobSystem.Schedule(integrateRange, &secondStage, &firstStage);
+				}
+
+				jobSystem.Wait(secondStage);
+			});
+
+		if (threadCount == 1)
+			singleThreadTime = parallelForTime;
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< std::setw(8) << threadCount
+			<< std::setw(13) << parallelForTime << " ms"
+			<< std::setw(9) << singleThreadTime / parallelForTime << "x"
+			<< std::setw(13) << smallJobTime << " ms"
+			<< std::setw(13) << dependentTime << " ms" << std::endl;
+	}
+
+	return 0;
+}
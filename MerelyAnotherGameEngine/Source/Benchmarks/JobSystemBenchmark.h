@@ -0,0 +1,4 @@
+#pragma once
+
+// Measures how the job system scales from one thread up to every hardware thread.
+i32 RunJobSystemBenchmark();
@@ -0,0 +1,228 @@
+#include "Benchmarks/PhysicsBenchmark.h"
+
+#include "Benchmarks/BenchmarkUtils.h"
+#include "Physics/PhysicsSystem.h"
+
+#include <extensions/PxCustomGeometryExt.h>
+
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	constexpr u32 cBodiesPerSide = 16;
+	constexpr u32 cBodyLayers = 32;
+	constexpr f32 cBodyHalfExtent = 0.5f;
+	constexpr f32 cBodySpacing = 1.1f;
+
+	constexpr f32 cTimeStep = 1.0f / 60.0f;
+	constexpr u32 cWarmUpSteps = 30;
+	constexpr u32 cMeasuredSteps = 300;
+
+	constexpr u32 cReportedAllocationCategories = 8;
+
+	constexpr u32 cPrimitivesPerSide = 12;
+	constexpr f32 cPrimitiveSpacing = 3.0f;
+	constexpr f32 cPrimitiveRadius = 0.8f;
+	constexpr f32 cPrimitiveHeight = 2.0f;
+	constexpr u32 cBallLayers = 8;
+	constexpr f32 cBallRadius = 0.4f;
+
+	// A grid of boxes dropped onto the ground, so that most of the measured steps resolve a settling pile.
+	void CreateScene(PhysicsSystem& physicsSystem)
+	{
+		const PhysicsSystemMaterialPtr material = physicsSystem.CreateMaterial({ 0.5f, 0.5f, 0.1f });
+
+		const PhysicsRigidBodyParams groundParams
+		{
+			.Type = PhysicsSystemObjectType::RigidStatic,
+			.Geometry = std::make_shared<physx::PxBoxGeometry>(100.0f, 100.0f, 1.0f),
+			.Material = material
+		};
+
+		physicsSystem.AddRigidBody(groundParams, physx::PxTransform(0.0f, 0.0f, -1.0f), physx::PxVec3(0.0f), physx::PxVec3(0.0f));
+
+		const PhysicsRigidBodyParams bodyParams
+		{
+			.Type = PhysicsSystemObjectType::RigidDynamic,
+			.Geometry = std::make_shared<physx::PxBoxGeometry>(cBodyHalfExtent, cBodyHalfExtent, cBodyHalfExtent),
+			.Material = material
+		};
+
+		const f32 gridOffset = 0.5f * cBodySpacing * f32(cBodiesPerSide - 1);
+
+		for (u32 layer = 0; layer < cBodyLayers; ++layer)
+			for (u32 y = 0; y < cBodiesPerSide; ++y)
+				for (u32 x = 0; x < cBodiesPerSide; ++x)
+				{
+					const physx::PxTransform pose(
+						f32(x) * cBodySpacing - gridOffset,
+						f32(y) * cBodySpacing - gridOffset,
+						cBodyHalfExtent + f32(layer) * cBodySpacing);
+
+					physicsSystem.AddRigidBody(bodyParams, pose, physx::PxVec3(0.0f), physx::PxVec3(0.0f));
+				}
+	}
+
+	// Static cylinders and cones standing on the ground in a checkerboard, with layers of balls
+	// dropped onto them, so that most contacts involve one of the primitives.
+	void CreatePrimitiveScene(PhysicsSystem& physicsSystem, bool useConvexHulls)
+	{
+		const PhysicsSystemMaterialPtr material = physicsSystem.CreateMaterial({ 0.5f, 0.5f, 0.3f });
+
+		const PhysicsRigidBodyParams groundParams
+		{
+			.Type = PhysicsSystemObjectType::RigidStatic,
+			.Geometry = std::make_shared<physx::PxBoxGeometry>(100.0f, 100.0f, 1.0f),
+			.Material = material
+		};
+
+		physicsSystem.AddRigidBody(groundParams, physx::PxTransform(0.0f, 0.0f, -1.0f), physx::PxVec3(0.0f), physx::PxVec3(0.0f));
+
+		const auto cylinderCallbacks = std::make_shared<physx::PxCustomGeometryExt::CylinderCallbacks>(cPrimitiveHeight, cPrimitiveRadius);
+		const PhysicsRigidBodyParams cylinderParams
+		{
+			.Type = PhysicsSystemObjectType::RigidStatic,
+			.CustomGeometryCallbacks = cylinderCallbacks,
+			.Geometry = std::make_shared<physx::PxCustomGeometry>(*cylinderCallbacks),
+			.Material = material,
+			.UseConvexHull = useConvexHulls
+		};
+
+		const auto coneCallbacks = std::make_shared<physx::PxCustomGeometryExt::ConeCallbacks>(cPrimitiveHeight, cPrimitiveRadius);
+		const PhysicsRigidBodyParams coneParams
+		{
+			.Type = PhysicsSystemObjectType::RigidStatic,
+			.CustomGeometryCallbacks = coneCallbacks,
+			.Geometry = std::make_shared<physx::PxCustomGeometry>(*coneCallbacks),
+			.Material = material,
+			.UseConvexHull = useConvexHulls
+		};
+
+		const PhysicsRigidBodyParams ballParams
+		{
+			.Type = PhysicsSystemObjectType::RigidDynamic,
+			.Geometry = std::make_shared<physx::PxSphereGeometry>(cBallRadius),
+			.Material = material
+		};
+
+		const f32 gridOffset = 0.5f * cPrimitiveSpacing * f32(cPrimitivesPerSide - 1);
+
+		// The primitives' axis is x, so stand them up along z.
+		const physx::PxQuat upright(-physx::PxHalfPi, physx::PxVec3(0.0f, 1.0f, 0.0f));
+
+		for (u32 y = 0; y < cPrimitivesPerSide; ++y)
+			for (u32 x = 0; x < cPrimitivesPerSide; ++x)
+			{
+				const physx::PxVec3 position(f32(x) * cPrimitiveSpacing - gridOffset, f32(y) * cPrimitiveSpacing - gridOffset, 0.5f * cPrimitiveHeight);
+				physicsSystem.AddRigidBody((x + y) % 2 ? coneParams : cylinderParams, physx::PxTransform(position, upright), physx::PxVec3(0.0f), physx::PxVec3(0.0f));
+			}
+
+		// Offset from the primitives' centers, so that balls land on edges and slopes.
+		for (u32 layer = 0; layer < cBallLayers; ++layer)
+			for (u32 y = 0; y < cPrimitivesPerSide; ++y)
+				for (u32 x = 0; x < cPrimitivesPerSide; ++x)
+				{
+					const physx::PxTransform pose(
+						f32(x) * cPrimitiveSpacing - gridOffset + 0.5f * cPrimitiveRadius,
+						f32(y) * cPrimitiveSpacing - gridOffset + 0.25f * cPrimitiveRadius,
+						cPrimitiveHeight + cBallRadius + f32(layer) * 3.0f * cBallRadius);
+
+					physicsSystem.AddRigidBody(ballParams, pose, physx::PxVec3(0.0f), physx::PxVec3(0.0f));
+				}
+	}
+}
+
+i32 RunPhysicsBenchmark()
+{
+	std::cout << "Physics: " << cBodiesPerSide * cBodiesPerSide * cBodyLayers << " dynamic boxes, " << cMeasuredSteps << " steps of " << cTimeStep << " s" << std::endl;
+	std::cout << std::setw(8) << "threads" << std::setw(16) << "per step" << std::setw(10) << "speedup" << std::endl;
+
+	f64 singleThreadTime = 0.0;
+	mage::Array<PhysicsAllocationStats> allocationStats;
+	u64 systemBytes = 0;
+	u64 steadyStateSystemAllocations = 0;
+
+	for (u32 threadCount : Benchmark::GetThreadCounts())
+	{
+		mage::JobSystem jobSystem({ .ThreadCount = threadCount });
+		PhysicsSystem physicsSystem(jobSystem);
+
+		CreateScene(physicsSystem);
+
+		for (u32 step = 0; step < cWarmUpSteps; ++step)
+			physicsSystem.Update(cTimeStep);
+
+		const u64 systemAllocationCount = physicsSystem.GetAllocator().GetSystemAllocationCount();
+
+		const f64 totalTime = Benchmark::MeasureMilliseconds(1, [&physicsSystem]()
+			{
+				for (u32 step = 0; step < cMeasuredSteps; ++step)
+					physicsSystem.Update(cTimeStep);
+			});
+
+		const f64 stepTime = totalTime / f64(cMeasuredSteps);
+
+		if (threadCount == 1)
+			singleThreadTime = stepTime;
+
+		allocationStats = physicsSystem.GetAllocator().GetStats();
+		systemBytes = physicsSystem.GetAllocator().GetSystemBytes();
+		steadyStateSystemAllocations = physicsSystem.GetAllocator().GetSystemAllocationCount() - systemAllocationCount;
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< std::setw(8) << threadCount
+			<< std::setw(13) << stepTime << " ms"
+			<< std::setw(9) << singleThreadTime / stepTime << "x" << std::endl;
+	}
+
+	std::cout << std::endl << "PhysX memory with " << Benchmark::GetThreadCounts().GetLast() << " threads: " << systemBytes / 1024 << " KB from the system, "
+		<< steadyStateSystemAllocations << " system allocations during the measured steps" << std::endl;
+
+	for (u32 i = 0; i < std::min(allocationStats.GetSize(), cReportedAllocationCategories); ++i)
+	{
+		const PhysicsAllocationStats& stats = allocationStats[i];
+		std::cout << std::setw(12) << stats.LiveBytes / 1024 << " KB" << std::setw(10) << stats.LiveAllocations << " live  " << stats.TypeName << std::endl;
+	}
+
+	return 0;
+}
+
+i32 RunPrimitiveCollisionBenchmark()
+{
+	std::cout << "Primitive collision: " << cPrimitivesPerSide * cPrimitivesPerSide << " cylinders and cones, "
+		<< cPrimitivesPerSide * cPrimitivesPerSide * cBallLayers << " balls, " << cMeasuredSteps << " steps of " << cTimeStep << " s" << std::endl;
+	std::cout << std::setw(18) << "collision" << std::setw(16) << "per step" << std::setw(10) << "speedup" << std::endl;
+
+	mage::JobSystem jobSystem;
+
+	f64 customGeometryTime = 0.0;
+
+	for (bool useConvexHulls : { false, true })
+	{
+		PhysicsSystem physicsSystem(jobSystem);
+
+		CreatePrimitiveScene(physicsSystem, useConvexHulls);
+
+		for (u32 step = 0; step < cWarmUpSteps; ++step)
+			physicsSystem.Update(cTimeStep);
+
+		const f64 totalTime = Benchmark::MeasureMilliseconds(1, [&physicsSystem]()
+			{
+				for (u32 step = 0; step < cMeasuredSteps; ++step)
+					physicsSystem.Update(cTimeStep);
+			});
+
+		const f64 stepTime = totalTime / f64(cMeasuredSteps);
+
+		if (!useConvexHulls)
+			customGeometryTime = stepTime;
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< std::setw(18) << (useConvexHulls ? "convex hull" : "custom geometry")
+			<< std::setw(13) << stepTime << " ms"
+			<< std::setw(9) << customGeometryTime / stepTime << "x" << std::endl;
+	}
+
+	return 0;
+}
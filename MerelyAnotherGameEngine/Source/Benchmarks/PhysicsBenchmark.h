@@ -0,0 +1,8 @@
+#pragma once
+
+// Measures PxScene::simulate throughput in a dense dynamic-body scene at different thread counts.
+i32 RunPhysicsBenchmark();
+
+// Compares stepping balls bouncing through a field of cylinders and cones when those collide as
+// custom geometries and as convex hulls.
+i32 RunPrimitiveCollisionBenchmark();
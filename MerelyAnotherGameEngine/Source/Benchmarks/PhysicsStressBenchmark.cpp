@@ -0,0 +1,275 @@
+#include "Benchmarks/PhysicsStressBenchmark.h"
+
+#include "Benchmarks/BenchmarkUtils.h"
+#include "Core/JobSystem.h"
+#include "Physics/PhysicsSystem.h"
+
+#include <extensions/PxCustomGeometryExt.h>
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace
+{
+	// Same arena as the game.
+	constexpr f32 cBoardSize = 20.0f;
+
+	constexpr f32 cCornerHalfHeight = 3.0f;
+	constexpr f32 cCornerRadius = 4.0f;
+	constexpr f32 cCornerPosition = cBoardSize - cCornerRadius;
+
+	constexpr f32 cCapsuleDistance = cCornerPosition + 4.0f;
+	constexpr f32 cCapsuleElevation = 2.0f;
+	constexpr f32 cCapsuleRadius = 2.0f;
+	constexpr f32 cCapsuleLength = 1.5f;
+	constexpr f32 cCapsuleTravel = 10.0f;
+
+	constexpr f32 cConeHeight = 8.0f;
+	constexpr f32 cConeRadius = 5.0f;
+
+	constexpr f32 cBallRadius = 1.0f;
+	constexpr f32 cBallSpeed = 10.0f;
+	constexpr f32 cKillZ = -10.0f;
+
+	constexpr f32 cTimeStep = 1.0f / 60.0f;
+	constexpr u32 cWarmUpSteps = 60;
+
+	// Balls launched per step while below the target count, spread over the spawners.
+	constexpr u32 cSpawnsPerStep = 32;
+
+	struct Spawner
+	{
+		physx::PxVec3 Position;
+		physx::PxVec3 Forward;
+	};
+
+	struct Paddle
+	{
+		physx::PxRigidDynamic* Actor;
+		physx::PxTransform Origin;
+		physx::PxVec3 Extent;
+		f32 Phase;
+	};
+
+	struct Arena
+	{
+		mage::Array<Spawner> Spawners;
+		mage::Array<Paddle> Paddles;
+		mage::Array<physx::PxRigidActor*> Balls;
+
+		PhysicsRigidBodyParams BallParams;
+
+		std::mt19937 Random{ 1234 };
+		u32 StepIndex = 0;
+	};
+
+	// Rotation about z by the angle the game passes to mage::Rotor.
+	physx::PxQuat RotationAboutZ(f32 degrees)
+	{
+		return physx::PxQuat(-physx::PxPi * degrees / 180.0f, physx::PxVec3(0.0f, 0.0f, 1.0f));
+	}
+
+	void CreateArena(PhysicsSystem& physicsSystem, Arena& arena)
+	{
+		const PhysicsSystemMaterialPtr defaultMaterial = physicsSystem.CreateMaterial({ 0.2f, 0.1f, 1.0f });
+		const PhysicsSystemMaterialPtr floorMaterial = physicsSystem.CreateMaterial({ 0.2f, 0.05f, 0.0f });
+
+		const PhysicsRigidBodyParams boxParams = { PhysicsSystemObjectType::RigidStatic, nullptr, std::make_shared<physx::PxBoxGeometry>(cBoardSize, cBoardSize, 1.0f), floorMaterial, PhysicsCollisionLayer::Level };
+
+		const auto cylinderCallbacks = std::make_shared<physx::PxCustomGeometryExt::CylinderCallbacks>(2.0f * cCornerHalfHeight, cCornerRadius);
+		const PhysicsRigidBodyParams cylinderParams = { PhysicsSystemObjectType::RigidStatic, cylinderCallbacks, std::make_shared<physx::PxCustomGeometry>(*cylinderCallbacks), defaultMaterial, PhysicsCollisionLayer::Level };
+
+		const auto coneCallbacks = std::make_shared<physx::PxCustomGeometryExt::ConeCallbacks>(cConeHeight, cConeRadius);
+		const PhysicsRigidBodyParams coneParams = { PhysicsSystemObjectType::RigidStatic, coneCallbacks, std::make_shared<physx::PxCustomGeometry>(*coneCallbacks), defaultMaterial, PhysicsCollisionLayer::Level };
+
+		const PhysicsRigidBodyParams capsuleParams = { PhysicsSystemObjectType::RigidKinematic, nullptr, std::make_shared<physx::PxCapsuleGeometry>(cCapsuleRadius, cCapsuleLength), defaultMaterial, PhysicsCollisionLayer::Paddle };
+
+		arena.BallParams = { PhysicsSystemObjectType::RigidDynamic, nullptr, std::make_shared<physx::PxSphereGeometry>(cBallRadius), defaultMaterial, PhysicsCollisionLayer::Ball };
+
+		const physx::PxVec3 zero(0.0f);
+
+		physicsSystem.AddRigidBody(boxParams, physx::PxTransform(physx::PxIdentity), zero, zero);
+
+		// The primitives' axis is x, stood up along z.
+		const physx::PxQuat upright(-physx::PxHalfPi, physx::PxVec3(0.0f, 1.0f, 0.0f));
+
+		physicsSystem.AddRigidBody(coneParams, physx::PxTransform(zero, upright), zero, zero);
+
+		for (f32 x : { -cCornerPosition, cCornerPosition })
+			for (f32 y : { -cCornerPosition, cCornerPosition })
+				physicsSystem.AddRigidBody(cylinderParams, physx::PxTransform(physx::PxVec3(x, y, cCornerHalfHeight), upright), zero, zero);
+
+		const f32 paddleAngles[] = { 0.0f, 90.0f, 180.0f, -90.0f };
+
+		for (u32 i = 0; i < 4; ++i)
+		{
+			const physx::PxQuat rotation = RotationAboutZ(paddleAngles[i]);
+			const physx::PxTransform origin(rotation.rotate(physx::PxVec3(-cCapsuleDistance, 0.0f, cCapsuleElevation)), rotation);
+
+			physx::PxRigidActor* actor = physicsSystem.AddRigidBody(capsuleParams, origin, zero, zero);
+			arena.Paddles.Add({ static_cast<physx::PxRigidDynamic*>(actor), origin, rotation.rotate(physx::PxVec3(0.0f, -cCapsuleTravel, 0.0f)), f32(i) });
+
+			// Spawners stand behind the paddles like the player's camera, looking at the center.
+			const physx::PxVec3 spawnerPosition = rotation.rotate(physx::PxVec3(-30.0f, 0.0f, 10.0f));
+			arena.Spawners.Add({ spawnerPosition, (physx::PxVec3(0.0f, 0.0f, 2.0f) - spawnerPosition).getNormalized() });
+		}
+	}
+
+	// Everything the game does to the scene between two steps.
+	void UpdateArena(PhysicsSystem& physicsSystem, Arena& arena, u32 ballCount)
+	{
+		const f32 time = f32(arena.StepIndex++) * cTimeStep;
+
+		for (const Paddle& paddle : arena.Paddles)
+		{
+			if (paddle.Actor->getScene() == nullptr)
+				continue;
+
+			const physx::PxVec3 offset = paddle.Extent * std::sin(2.0f * time + paddle.Phase);
+			paddle.Actor->setKinematicTarget(physx::PxTransform(paddle.Origin.p + offset, paddle.Origin.q));
+		}
+
+		for (u32 i = 0; i < arena.Balls.GetSize();)
+		{
+			if (arena.Balls[i]->getScene() && arena.Balls[i]->getGlobalPose().p.z < cKillZ)
+			{
+				physicsSystem.RemoveActor(arena.Balls[i]);
+				arena.Balls.RemoveAtSwap(i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		std::uniform_real_distribution<f32> jitter(-0.1f, 0.1f);
+
+		for (u32 i = 0; i < cSpawnsPerStep && arena.Balls.GetSize() < ballCount; ++i)
+		{
+			const Spawner& spawner = arena.Spawners[i % arena.Spawners.GetSize()];
+			const physx::PxVec3 direction = (spawner.Forward + physx::PxVec3(jitter(arena.Random), jitter(arena.Random), jitter(arena.Random))).getNormalized();
+
+			// Step along the direction per spawn, so that balls from the same spawner do not start overlapping.
+			const physx::PxVec3 position = spawner.Position + direction * (2.5f * cBallRadius * f32(i / arena.Spawners.GetSize()));
+
+			arena.Balls.Add(physicsSystem.AddRigidBody(arena.BallParams, physx::PxTransform(position), cBallSpeed * direction, physx::PxVec3(0.0f)));
+		}
+	}
+
+	void PrintPercentiles(const char* name, mage::Array<f64>& times)
+	{
+		times.Sort();
+
+		f64 total = 0.0;
+		for (f64 time : times)
+			total += time;
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< std::setw(10) << name
+			<< std::setw(10) << total / f64(std::max(times.GetSize(), 1u))
+			<< std::setw(10) << Benchmark::GetPercentile(times, 50.0)
+			<< std::setw(10) << Benchmark::GetPercentile(times, 90.0)
+			<< std::setw(10) << Benchmark::GetPercentile(times, 99.0)
+			<< std::setw(10) << Benchmark::GetPercentile(times, 100.0) << std::endl;
+	}
+
+	const char* GetName(PhysicsSolverType solver)
+	{
+		return solver == PhysicsSolverType::TGS ? "TGS" : "PGS";
+	}
+
+	const char* GetName(PhysicsBroadPhaseType broadPhase)
+	{
+		switch (broadPhase)
+		{
+			case PhysicsBroadPhaseType::SAP: return "SAP";
+			case PhysicsBroadPhaseType::MBP: return "MBP";
+			case PhysicsBroadPhaseType::ABP: return "ABP";
+			case PhysicsBroadPhaseType::PABP: return "PABP";
+		}
+
+		return "?";
+	}
+}
+
+i32 RunPhysicsStressBenchmark(const mage::JobSystemSettings& jobSystemSettings, const PhysicsSystemSettings& physicsSettings, u32 arenaCount, u32 ballCount, u32 stepCount)
+{
+	mage::JobSystem jobSystem(jobSystemSettings);
+	PhysicsContext context(jobSystem);
+
+	PhysicsSystemSettings settings = physicsSettings;
+	settings.WorldBounds = physx::PxBounds3(physx::PxVec3(-40.0f, -40.0f, cKillZ - 10.0f), physx::PxVec3(40.0f, 40.0f, 40.0f));
+
+	std::cout << "Physics stress: " << arenaCount << " arenas of up to " << ballCount << " balls, " << stepCount << " steps, "
+		<< jobSystem.GetThreadCount() << " threads, solver " << GetName(settings.Solver)
+		<< ", broadphase " << GetName(settings.BroadPhase) << ", PCM " << (settings.EnablePcm ? "on" : "off") << std::endl;
+
+	// One scene per arena, all on the same context, like independent matches hosted by one process.
+	mage::Array<std::unique_ptr<PhysicsSystem>> physicsSystems;
+	mage::Array<std::unique_ptr<Arena>> arenas;
+	mage::Array<PhysicsSystem*> systemPointers;
+
+	for (u32 i = 0; i < arenaCount; ++i)
+	{
+		physicsSystems.Add(std::make_unique<PhysicsSystem>(context, settings));
+		arenas.Add(std::make_unique<Arena>());
+		systemPointers.Add(physicsSystems[i].get());
+
+		CreateArena(*physicsSystems[i], *arenas[i]);
+	}
+
+	for (u32 step = 0; step < cWarmUpSteps; ++step)
+	{
+		for (u32 i = 0; i < arenaCount; ++i)
+			UpdateArena(*physicsSystems[i], *arenas[i], ballCount);
+
+		PhysicsContext::Update(systemPointers, cTimeStep);
+	}
+
+	mage::Array<f64> beginTimes, endTimes, stepTimes;
+	beginTimes.Reserve(stepCount);
+	endTimes.Reserve(stepCount);
+	stepTimes.Reserve(stepCount);
+
+	u64 liveBallTotal = 0;
+
+	for (u32 step = 0; step < stepCount; ++step)
+	{
+		for (u32 i = 0; i < arenaCount; ++i)
+		{
+			UpdateArena(*physicsSystems[i], *arenas[i], ballCount);
+			liveBallTotal += arenas[i]->Balls.GetSize();
+		}
+
+		// Same as PhysicsContext::Update, timing both halves.
+		const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+		for (PhysicsSystem* physicsSystem : systemPointers)
+			physicsSystem->BeginSimulation(cTimeStep);
+
+		const std::chrono::steady_clock::time_point simulatedTime = std::chrono::steady_clock::now();
+
+		for (PhysicsSystem* physicsSystem : systemPointers)
+			physicsSystem->EndSimulation();
+
+		const std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+
+		beginTimes.Add(std::chrono::duration<f64, std::milli>(simulatedTime - startTime).count());
+		endTimes.Add(std::chrono::duration<f64, std::milli>(endTime - simulatedTime).count());
+		stepTimes.Add(std::chrono::duration<f64, std::milli>(endTime - startTime).count());
+	}
+
+	std::cout << "Average live balls per arena: " << liveBallTotal / std::max(u64(stepCount) * arenaCount, u64(1)) << std::endl;
+	std::cout << "PhysX memory: " << context.GetAllocator().GetSystemBytes() / 1024 << " KB, "
+		<< context.GetAllocator().GetSystemBytes() / 1024 / std::max(arenaCount, 1u) << " KB per arena" << std::endl;
+	std::cout << std::setw(10) << "ms" << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+
+	// Begin flushes actor changes, runs queued queries and kicks off the step; end waits for it,
+	// fetches the results and hands them to listeners.
+	PrintPercentiles("simulate", beginTimes);
+	PrintPercentiles("fetch", endTimes);
+	PrintPercentiles("step", stepTimes);
+
+	return 0;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Physics/PhysicsCommon.h"
+
+namespace mage
+{
+	struct JobSystemSettings;
+}
+
+// Runs copies of the game's arena with moving paddles while balls are launched into them the way
+// BallSpawnerComponent does, keeping up to ballCount of them alive in each. The arenas are scenes
+// sharing one PhysicsContext and are stepped together. Reports percentiles of the time spent
+// starting and finishing each step.
+i32 RunPhysicsStressBenchmark(const mage::JobSystemSettings& jobSystemSettings, const PhysicsSystemSettings& physicsSettings, u32 arenaCount, u32 ballCount, u32 stepCount);
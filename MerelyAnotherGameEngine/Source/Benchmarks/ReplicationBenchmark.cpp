@@ -0,0 +1,220 @@
+#include "Benchmarks/ReplicationBenchmark.h"
+
+#include "Benchmarks/BenchmarkUtils.h"
+#include "Game/WorldReplication.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace
+{
+	constexpr f32 cTimeStep = 1.0f / 60.0f;
+	constexpr f32 cGravity = 9.81f;
+	constexpr f32 cBoardSize = 20.0f;
+	constexpr f32 cBallRadius = 1.0f;
+	constexpr f32 cRestitution = 0.8f;
+
+	// One in this many objects is replaced each frame.
+	constexpr u32 cChurnDivisor = 1000;
+
+	struct Ball
+	{
+		u32 Id;
+		glm::vec3 Position;
+		glm::vec3 Velocity;
+		glm::vec3 SpinAxis;
+		f32 Spin;
+		f32 Angle;
+	};
+
+	Ball CreateBall(u32 id, std::mt19937& random)
+	{
+		std::uniform_real_distribution<f32> position(-cBoardSize + cBallRadius, cBoardSize - cBallRadius);
+		std::uniform_real_distribution<f32> velocity(-10.0f, 10.0f);
+		std::uniform_real_distribution<f32> unit(-1.0f, 1.0f);
+
+		Ball ball{ id, glm::vec3(position(random), position(random), cBallRadius + 5.0f + unit(random) * 4.0f) };
+
+		// Half the balls lie still, like the ones which settled on the board.
+		if (id % 2 == 0)
+		{
+			ball.Position.z = cBallRadius;
+			ball.SpinAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+			return ball;
+		}
+
+		ball.Velocity = glm::vec3(velocity(random), velocity(random), velocity(random));
+		ball.SpinAxis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 2.0f));
+		ball.Spin = 4.0f * unit(random);
+
+		return ball;
+	}
+
+	void UpdateBall(Ball& ball)
+	{
+		if (ball.Velocity == glm::vec3(0.0f) && ball.Position.z <= cBallRadius)
+			return;
+
+		ball.Velocity.z -= cGravity * cTimeStep;
+		ball.Position += ball.Velocity * cTimeStep;
+		ball.Angle += ball.Spin * cTimeStep;
+
+		for (u32 axis = 0; axis < 2; ++axis)
+		{
+			if (std::abs(ball.Position[axis]) > cBoardSize - cBallRadius)
+			{
+				ball.Position[axis] = std::copysign(cBoardSize - cBallRadius, ball.Position[axis]);
+				ball.Velocity[axis] = -ball.Velocity[axis];
+			}
+		}
+
+		if (ball.Position.z < cBallRadius)
+		{
+			ball.Position.z = cBallRadius;
+			ball.Velocity.z = -cRestitution * ball.Velocity.z;
+		}
+	}
+
+	template<typename Vector>
+	bool IsWithin(const Vector& a, const Vector& b, f32 tolerance)
+	{
+		return !glm::any(glm::greaterThan(glm::abs(a - b), Vector(tolerance)));
+	}
+
+	// Quantizing rounds to the nearest step, so a whole step leaves room for float error on top.
+	bool IsDecodedWithinStep(const ReplicatedObject& decoded, const ReplicatedObject& source)
+	{
+		const glm::vec4 decodedRotor(decoded.Transform.Rotation.S, decoded.Transform.Rotation.XY, decoded.Transform.Rotation.YZ, decoded.Transform.Rotation.ZX);
+		const glm::vec4 sourceRotor(source.Transform.Rotation.S, source.Transform.Rotation.XY, source.Transform.Rotation.YZ, source.Transform.Rotation.ZX);
+
+		return decoded.Id == source.Id
+			&& IsWithin(decoded.Transform.Position, source.Transform.Position, ReplicationEncoder::cPositionStep)
+			&& IsWithin(decodedRotor, sourceRotor, 1.0f / ReplicationEncoder::cRotorScale)
+			&& IsWithin(decoded.LinearVelocity, source.LinearVelocity, ReplicationEncoder::cVelocityStep)
+			&& IsWithin(decoded.AngularVelocity, source.AngularVelocity, ReplicationEncoder::cVelocityStep);
+	}
+
+	void PrintTimes(const char* name, mage::Array<f64>& times)
+	{
+		times.Sort();
+
+		f64 total = 0.0;
+		for (f64 time : times)
+			total += time;
+
+		std::cout << std::fixed << std::setprecision(1)
+			<< std::setw(10) << name
+			<< std::setw(10) << total / f64(std::max(times.GetSize(), 1u))
+			<< std::setw(10) << Benchmark::GetPercentile(times, 50.0)
+			<< std::setw(10) << Benchmark::GetPercentile(times, 99.0)
+			<< std::setw(10) << Benchmark::GetPercentile(times, 100.0) << std::endl;
+	}
+}
+
+i32 RunReplicationBenchmark(u32 objectCount, u32 frameCount)
+{
+	std::mt19937 random(1234);
+
+	mage::Array<Ball> balls;
+	for (u32 i = 0; i < objectCount; ++i)
+		balls.Add(CreateBall(i, random));
+
+	u32 nextId = objectCount;
+	const u32 churnCount = objectCount / cChurnDivisor;
+
+	ReplicationEncoder encoder;
+	ReplicationDecoder decoder;
+
+	mage::Array<ReplicatedObject> objects;
+	mage::Array<u8> message;
+
+	mage::Array<f64> encodeTimes, decodeTimes;
+	encodeTimes.Reserve(frameCount);
+	decodeTimes.Reserve(frameCount);
+
+	// Scales a frame's time to microseconds per 10k objects.
+	const f64 timeScale = 1000.0 * 10000.0 / f64(std::max(objectCount, 1u));
+
+	u64 firstMessageSize = 0;
+	u64 totalMessageSize = 0;
+	u32 mismatchCount = 0;
+
+	for (u32 frame = 0; frame <= frameCount; ++frame)
+	{
+		if (frame > 0)
+		{
+			for (Ball& ball : balls)
+				UpdateBall(ball);
+
+			// The oldest balls leave and new ones come in, which keeps the ids sorted.
+			for (u32 i = 0; i < churnCount; ++i)
+				balls.Add(CreateBall(nextId++, random));
+
+			for (u32 i = 0; i < churnCount; ++i)
+				balls.RemoveAt(0);
+		}
+
+		objects.ResizeUninitialized(balls.GetSize());
+
+		for (u32 i = 0; i < balls.GetSize(); ++i)
+		{
+			const Ball& ball = balls[i];
+			objects[i] = { ball.Id, { ball.Position, mage::Rotor(ball.SpinAxis, ball.Angle) }, ball.Velocity, ball.Spin * ball.SpinAxis };
+		}
+
+		const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		encoder.Encode(objects, message);
+		const std::chrono::steady_clock::time_point encodedTime = std::chrono::steady_clock::now();
+		const bool isDecoded = decoder.Decode(message.GetData(), message.GetSize());
+		const std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+
+		// The first message has every object in full, the rest only what changed.
+		if (frame == 0)
+		{
+			firstMessageSize = message.GetSize();
+		}
+		else
+		{
+			totalMessageSize += message.GetSize();
+			encodeTimes.Add(std::chrono::duration<f64, std::milli>(encodedTime - startTime).count() * timeScale);
+			decodeTimes.Add(std::chrono::duration<f64, std::milli>(endTime - encodedTime).count() * timeScale);
+		}
+
+		const mage::Array<ReplicatedObject>& decoded = decoder.GetObjects();
+		if (!isDecoded || decoded.GetSize() != objects.GetSize())
+		{
+			++mismatchCount;
+			continue;
+		}
+
+		for (u32 i = 0; i < objects.GetSize(); ++i)
+		{
+			if (!IsDecodedWithinStep(decoded[i], objects[i]))
+			{
+				++mismatchCount;
+				break;
+			}
+		}
+	}
+
+	const u64 rawSize = u64(objectCount) * (sizeof(u32) + 13 * sizeof(f32));
+	const f64 meanMessageSize = f64(totalMessageSize) / f64(std::max(frameCount, 1u));
+
+	std::cout << "Replication: " << objectCount << " objects, " << frameCount << " frames, " << churnCount << " replaced per frame" << std::endl;
+	std::cout << std::fixed << std::setprecision(1)
+		<< "Bytes per frame: " << meanMessageSize << " (" << 100.0 * meanMessageSize / f64(rawSize) << "% of " << rawSize << " raw), first frame "
+		<< firstMessageSize << std::endl;
+	std::cout << std::setw(10) << "us/10k" << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+
+	PrintTimes("encode", encodeTimes);
+	PrintTimes("decode", decodeTimes);
+
+	if (mismatchCount > 0)
+	{
+		std::cout << "Decoded state differed from the source in " << mismatchCount << " frames" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Streams the states of objectCount synthetic objects through ReplicationEncoder and ReplicationDecoder
+// for frameCount frames: balls bouncing around an arena-sized box, half of them at rest, with a few
+// replaced by new ones every frame. Reports the bytes per message next to the raw state, and the time
+// to encode and decode a message scaled to 10k objects.
+i32 RunReplicationBenchmark(u32 objectCount, u32 frameCount);
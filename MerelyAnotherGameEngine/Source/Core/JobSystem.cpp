@@ -0,0 +1,329 @@
+#include "Core/JobSystem.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+namespace mage
+{
+	namespace
+	{
+		thread_local JobSystem const* tCurrentJobSystem = nullptr;
+		thread_local i32 tCurrentWorkerIndex = -1;
+
+#ifdef _WIN32
+		// Hardware threads are numbered across processor groups, which hold up to 64 each, so
+		// machines with more than 64 of them need group affinity rather than a single mask.
+		void PinToHardwareThread(std::thread& inThread, u32 inHardwareThread)
+		{
+			const WORD groupCount = GetActiveProcessorGroupCount();
+
+			for (WORD group = 0; group < groupCount; ++group)
+			{
+				const DWORD groupSize = GetActiveProcessorCount(group);
+
+				if (inHardwareThread < groupSize)
+				{
+					GROUP_AFFINITY affinity = {};
+					affinity.Group = group;
+					affinity.Mask = KAFFINITY(1) << inHardwareThread;
+
+					mage_ensure(SetThreadGroupAffinity(inThread.native_handle(), &affinity, nullptr));
+					return;
+				}
+
+				inHardwareThread -= groupSize;
+			}
+		}
+#endif
+	}
+
+	JobSystem::JobSystem(JobSystemSettings const& inSettings)
+	{
+		const u32 hardwareThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		const u32 workerCount = (inSettings.ThreadCount ? inSettings.ThreadCount : hardwareThreadCount) - 1;
+
+		mQueues.Reserve(workerCount);
+		for (u32 i = 0; i < workerCount; ++i)
+			mQueues.Add(new JobQueue());
+
+		mWorkers.Reserve(workerCount);
+		for (u32 i = 0; i < workerCount; ++i)
+		{
+			mWorkers.Add(std::thread(&JobSystem::WorkerMain, this, i));
+
+#ifdef _WIN32
+			if (inSettings.PinWorkers)
+				PinToHardwareThread(mWorkers[i], (i + 1) % hardwareThreadCount);
+#endif
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		mIsRunning = false;
+		mWorkEpoch.fetch_add(1);
+		mWorkEpoch.notify_all();
+
+		for (std::thread& worker : mWorkers)
+			worker.join();
+
+		mage_ensure(mDeferredJobs.IsEmpty() && mInjectionQueue.Jobs.empty());
+
+		for (JobQueue* queue : mQueues)
+		{
+			for (Job* job : queue->FreeJobs)
+				delete job;
+
+			delete queue;
+		}
+
+		for (Job* job : mFreeJobs)
+			delete job;
+	}
+
+	i32 JobSystem::GetCurrentWorkerIndex() const
+	{
+		return tCurrentJobSystem == this ? tCurrentWorkerIndex : -1;
+	}
+
+	void JobSystem::Schedule(JobFunction&& inFunction, JobCounter* inCounter, JobCounter const* inDependency)
+	{
+		if (inCounter)
+			inCounter->mPendingJobs.fetch_add(1);
+
+		Job* job = AllocateJob(GetCurrentWorkerIndex());
+		job->Function = std::move(inFunction);
+		job->Counter = inCounter;
+		job->DependencyId = inDependency ? inDependency->mId : 0;
+
+		if (inDependency)
+		{
+			// Announce the deferred job before checking the dependency, so that either this thread
+			// sees the dependency finish or the finishing thread sees the deferred job.
+			std::lock_guard lock(mDeferredMutex);
+			mDeferredJobCount.fetch_add(1);
+
+			if (!inDependency->IsDone())
+			{
+				mDeferredJobs.Add(job);
+				return;
+			}
+
+			mDeferredJobCount.fetch_sub(1);
+		}
+
+		Push(job);
+	}
+
+	void JobSystem::Wait(JobCounter const& inCounter)
+	{
+		WaitUntil([&inCounter]() { return inCounter.IsDone(); });
+	}
+
+	void JobSystem::ParallelForRange(u32 inCount, u32 inBatchSize, RangeFunction const& inFunction)
+	{
+		if (inCount == 0)
+			return;
+
+		// A few batches per thread keeps threads busy when some batches run slower than others.
+		const u32 batchSize = inBatchSize ? inBatchSize : std::max((inCount + 4 * GetThreadCount() - 1) / (4 * GetThreadCount()), 1u);
+		const u32 batchCount = (inCount + batchSize - 1) / batchSize;
+
+		JobCounter counter;
+
+		for (u32 batch = 1; batch < batchCount; ++batch)
+		{
+			const u32 begin = batch * batchSize;
+			const u32 end = std::min(begin + batchSize, inCount);
+			Schedule([&inFunction, begin, end]() { inFunction(begin, end); }, &counter);
+		}
+
+		inFunction(0, std::min(batchSize, inCount));
+
+		Wait(counter);
+	}
+
+	void JobSystem::WorkerMain(u32 inWorkerIndex)
+	{
+		tCurrentJobSystem = this;
+		tCurrentWorkerIndex = i32(inWorkerIndex);
+
+		while (mIsRunning)
+		{
+			if (TryRunJob(i32(inWorkerIndex)))
+				continue;
+
+			// Re-check after reading the epoch: a push in between changes the epoch and wakes us.
+			const u32 epoch = mWorkEpoch.load();
+
+			if (TryRunJob(i32(inWorkerIndex)))
+				continue;
+
+			if (mIsRunning)
+				mWorkEpoch.wait(epoch);
+		}
+	}
+
+	void JobSystem::Push(Job* inJob)
+	{
+		const i32 workerIndex = GetCurrentWorkerIndex();
+		JobQueue& queue = workerIndex >= 0 ? *mQueues[workerIndex] : mInjectionQueue;
+
+		{
+			std::lock_guard lock(queue.Mutex);
+			queue.Jobs.push_back(inJob);
+		}
+
+		mWorkEpoch.fetch_add(1);
+		mWorkEpoch.notify_one();
+	}
+
+	JobSystem::Job* JobSystem::PopOrSteal(i32 inWorkerIndex)
+	{
+		if (inWorkerIndex >= 0)
+		{
+			JobQueue& queue = *mQueues[inWorkerIndex];
+			std::lock_guard lock(queue.Mutex);
+
+			if (!queue.Jobs.empty())
+			{
+				Job* job = queue.Jobs.back();
+				queue.Jobs.pop_back();
+				return job;
+			}
+		}
+
+		{
+			std::lock_guard lock(mInjectionQueue.Mutex);
+
+			if (!mInjectionQueue.Jobs.empty())
+			{
+				Job* job = mInjectionQueue.Jobs.front();
+				mInjectionQueue.Jobs.pop_front();
+				return job;
+			}
+		}
+
+		// Start at the next worker so that thieves spread over the victims.
+		const u32 queueCount = mQueues.GetSize();
+		for (u32 i = 1; i <= queueCount; ++i)
+		{
+			const u32 victimIndex = u32(inWorkerIndex + i) % queueCount;
+			if (i32(victimIndex) == inWorkerIndex)
+				continue;
+
+			JobQueue& victim = *mQueues[victimIndex];
+			std::unique_lock lock(victim.Mutex, std::try_to_lock);
+
+			if (lock.owns_lock() && !victim.Jobs.empty())
+			{
+				Job* job = victim.Jobs.front();
+				victim.Jobs.pop_front();
+				return job;
+			}
+		}
+
+		return nullptr;
+	}
+
+	bool JobSystem::TryRunJob(i32 inWorkerIndex)
+	{
+		Job* job = PopOrSteal(inWorkerIndex);
+		if (!job)
+			return false;
+
+		Run(job, inWorkerIndex);
+		return true;
+	}
+
+	void JobSystem::Run(Job* inJob, i32 inWorkerIndex)
+	{
+		inJob->Function();
+
+		JobCounter* counter = inJob->Counter;
+		FreeJob(inJob, inWorkerIndex);
+
+		if (!counter)
+			return;
+
+		// The counter may be destroyed as soon as it reaches zero, so its id is read before.
+		const u64 counterId = counter->mId;
+		if (counter->mPendingJobs.fetch_sub(1) == 1)
+			ReleaseDependents(counterId);
+	}
+
+	JobSystem::Job* JobSystem::AllocateJob(i32 inWorkerIndex)
+	{
+		if (inWorkerIndex >= 0)
+		{
+			mage::Array<Job*>& freeJobs = mQueues[inWorkerIndex]->FreeJobs;
+
+			if (!freeJobs.IsEmpty())
+			{
+				Job* job = freeJobs.GetLast();
+				freeJobs.RemoveAt(freeJobs.GetSize() - 1);
+				return job;
+			}
+		}
+
+		{
+			std::lock_guard lock(mFreeJobsMutex);
+
+			if (!mFreeJobs.IsEmpty())
+			{
+				Job* job = mFreeJobs.GetLast();
+				mFreeJobs.RemoveAt(mFreeJobs.GetSize() - 1);
+				return job;
+			}
+		}
+
+		return new Job();
+	}
+
+	void JobSystem::FreeJob(Job* inJob, i32 inWorkerIndex)
+	{
+		// Captures are released now rather than whenever the job is reused.
+		inJob->Function = nullptr;
+
+		if (inWorkerIndex >= 0 && mQueues[inWorkerIndex]->FreeJobs.GetSize() < cMaxCachedJobsPerWorker)
+		{
+			mQueues[inWorkerIndex]->FreeJobs.Add(inJob);
+			return;
+		}
+
+		std::lock_guard lock(mFreeJobsMutex);
+		mFreeJobs.Add(inJob);
+	}
+
+	void JobSystem::ReleaseDependents(u64 inCounterId)
+	{
+		if (mDeferredJobCount.load() == 0)
+			return;
+
+		mage::Array<Job*> releasedJobs;
+
+		{
+			std::lock_guard lock(mDeferredMutex);
+
+			for (u32 i = 0; i < mDeferredJobs.GetSize();)
+			{
+				if (mDeferredJobs[i]->DependencyId == inCounterId)
+				{
+					releasedJobs.Add(mDeferredJobs[i]);
+					mDeferredJobs.RemoveAtSwap(i);
+					mDeferredJobCount.fetch_sub(1);
+				}
+				else
+				{
+					++i;
+				}
+			}
+		}
+
+		for (Job* job : releasedJobs)
+			Push(job);
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace mage
+{
+	class JobSystem;
+
+	// Counts the jobs scheduled against it which have not finished yet. Must outlive those jobs and
+	// any job which depends on it.
+	class JobCounter : public NonMovableClass
+	{
+	public:
+		JobCounter() : mId(sNextId.fetch_add(1)) {}
+
+		bool IsDone() const { return mPendingJobs.load() == 0; }
+
+	private:
+		friend JobSystem;
+
+		static inline std::atomic<u64> sNextId = 1;
+
+		std::atomic<u32> mPendingJobs = 0;
+
+		// What dependent jobs wait on. Unlike the counter's address, a later counter never reuses it.
+		const u64 mId;
+	};
+
+	struct JobSystemSettings
+	{
+		// Number of threads executing jobs, including the thread which waits on them. Zero picks one
+		// per hardware thread.
+		u32 ThreadCount = 0;
+
+		// Pins worker i to hardware thread i + 1, leaving hardware thread 0 to the main thread.
+		bool PinWorkers = false;
+	};
+
+	// Work-stealing scheduler. Every worker owns a deque; it pops its own jobs LIFO and steals other
+	// workers' jobs FIFO. Jobs scheduled from outside the pool go to a shared injection queue.
+	class JobSystem : public NonCopyableClass
+	{
+	public:
+		using JobFunction = std::function<void()>;
+		using RangeFunction = std::function<void(u32 inBegin, u32 inEnd)>;
+
+		JobSystem(JobSystemSettings const& inSettings = {});
+		~JobSystem();
+
+		u32 GetWorkerCount() const { return mWorkers.GetSize(); }
+
+		// Number of threads which can execute jobs at once, counting a thread that is waiting.
+		u32 GetThreadCount() const { return mWorkers.GetSize() + 1; }
+
+		// Index of the calling worker thread, or -1 when called from outside this job system.
+		i32 GetCurrentWorkerIndex() const;
+
+		// Runs inFunction on some thread. The job is added to inCounter if provided and is held back
+		// until inDependency (if provided) is done. Jobs are pooled, so functions whose captures fit
+		// in std::function's inline storage schedule without allocating.
+		void Schedule(JobFunction&& inFunction, JobCounter* inCounter = nullptr, JobCounter const* inDependency = nullptr);
+
+		// Blocks until inCounter is done, executing other jobs in the meantime.
+		void Wait(JobCounter const& inCounter);
+
+		// Same as Wait, for work tracked outside of the job system.
+		template<typename Predicate>
+		void WaitUntil(Predicate const& inIsDone)
+		{
+			const i32 workerIndex = GetCurrentWorkerIndex();
+
+			while (!inIsDone())
+				if (!TryRunJob(workerIndex))
+					std::this_thread::yield();
+		}
+
+		// Calls inFunction on consecutive sub-ranges of [0, inCount) and waits for all of them. The
+		// calling thread runs the first range itself. A zero batch size splits the range evenly.
+		void ParallelForRange(u32 inCount, u32 inBatchSize, RangeFunction const& inFunction);
+
+		template<typename Type, typename Function>
+		void ParallelFor(mage::Array<Type>& inArray, Function const& inFunction, u32 inBatchSize = 0)
+		{
+			ParallelForRange(inArray.GetSize(), inBatchSize, [&inArray, &inFunction](u32 inBegin, u32 inEnd)
+				{
+					for (u32 i = inBegin; i < inEnd; ++i)
+						inFunction(inArray[i]);
+				});
+		}
+
+		template<typename Type, typename Function>
+		void ParallelFor(mage::Array<Type> const& inArray, Function const& inFunction, u32 inBatchSize = 0)
+		{
+			ParallelForRange(inArray.GetSize(), inBatchSize, [&inArray, &inFunction](u32 inBegin, u32 inEnd)
+				{
+					for (u32 i = inBegin; i < inEnd; ++i)
+						inFunction(inArray[i]);
+				});
+		}
+
+	private:
+		// Jobs a worker keeps for itself before handing freed ones to the shared pool.
+		static constexpr u32 cMaxCachedJobsPerWorker = 256;
+
+		struct Job
+		{
+			JobFunction Function;
+			JobCounter* Counter = nullptr;
+			u64 DependencyId = 0;
+		};
+
+		struct JobQueue
+		{
+			std::mutex Mutex;
+			std::deque<Job*> Jobs;
+
+			// Only touched by the owning worker.
+			mage::Array<Job*> FreeJobs;
+		};
+
+		void WorkerMain(u32 inWorkerIndex);
+
+		void Push(Job* inJob);
+		Job* PopOrSteal(i32 inWorkerIndex);
+		bool TryRunJob(i32 inWorkerIndex);
+		void Run(Job* inJob, i32 inWorkerIndex);
+
+		Job* AllocateJob(i32 inWorkerIndex);
+		void FreeJob(Job* inJob, i32 inWorkerIndex);
+
+		void ReleaseDependents(u64 inCounterId);
+
+		mage::Array<std::thread> mWorkers;
+		mage::Array<JobQueue*> mQueues;
+		JobQueue mInjectionQueue;
+
+		// Bumped on every push so that sleeping workers cannot miss a job.
+		std::atomic<u32> mWorkEpoch = 0;
+		std::atomic<bool> mIsRunning = true;
+
+		// Jobs held back until their dependency is done.
+		std::mutex mDeferredMutex;
+		mage::Array<Job*> mDeferredJobs;
+		std::atomic<u32> mDeferredJobCount = 0;
+
+		// Freed jobs for threads outside the pool, and for workers which ran out of their own.
+		std::mutex mFreeJobsMutex;
+		mage::Array<Job*> mFreeJobs;
+	};
+}
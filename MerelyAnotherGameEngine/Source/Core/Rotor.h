@@ -56,6 +56,27 @@ namespace mage
 			return result;
 		}
 
+		// Normalized linear interpolation along the shorter arc; close to slerp for small angles.
+		static Rotor NLerp(Rotor inFrom, Rotor inTo, f32 inAlpha)
+		{
+			const f32 dot = inFrom.S * inTo.S + inFrom.XY * inTo.XY + inFrom.YZ * inTo.YZ + inFrom.ZX * inTo.ZX;
+			const f32 toWeight = dot < 0.0f ? -inAlpha : inAlpha;
+			const f32 fromWeight = 1.0f - inAlpha;
+
+			Rotor result;
+			result.S = fromWeight * inFrom.S + toWeight * inTo.S;
+			result.XY = fromWeight * inFrom.XY + toWeight * inTo.XY;
+			result.YZ = fromWeight * inFrom.YZ + toWeight * inTo.YZ;
+			result.ZX = fromWeight * inFrom.ZX + toWeight * inTo.ZX;
+
+			const f32 invLength = 1.0f / glm::sqrt(result.S * result.S + result.XY * result.XY + result.YZ * result.YZ + result.ZX * result.ZX);
+			result.S *= invLength;
+			result.XY *= invLength;
+			result.YZ *= invLength;
+			result.ZX *= invLength;
+			return result;
+		}
+
 		f32 S;
 		f32 XY;
 		f32 YZ;
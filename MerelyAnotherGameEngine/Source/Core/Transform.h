@@ -34,6 +34,14 @@ namespace mage
 			};
 		}
 
+		static Transform Interpolate(Transform const& inFrom, Transform const& inTo, f32 inAlpha)
+		{
+			Transform result;
+			result.Position = glm::mix(inFrom.Position, inTo.Position, inAlpha);
+			result.Rotation = Rotor::NLerp(inFrom.Rotation, inTo.Rotation, inAlpha);
+			return result;
+		}
+
 		glm::vec3 Position = { 0.0f, 0.0f, 0.0f };
 		mage::Rotor Rotation;
 	};
@@ -12,6 +12,17 @@ namespace mage
 		(HashCombine(inSeed, inRest), ...);
 	};
 
+	// FNV-1a, which unlike std::hash gives the same result in every build, so it can name files.
+	inline u64 HashBytes(void const* inData, u64 inSize, u64 inSeed = 0xcbf29ce484222325)
+	{
+		u8 const* bytes = static_cast<u8 const*>(inData);
+
+		for (u64 i = 0; i < inSize; ++i)
+			inSeed = (inSeed ^ bytes[i]) * 0x100000001b3;
+
+		return inSeed;
+	}
+
 	inline mage::Array<u8> ReadFile(mage::StringView inPath)
 	{
 		mage::Array<u8> data;
@@ -1,13 +1,25 @@
 #include "Game/CameraComponent.h"
 #include "Game/GameWorld.h"
+#include "Game/WorldSnapshot.h"
 #include "Rendering/Systems/MeshRenderSystem.h"
 
+static const bool sIsSnapshotRegistered = WorldSnapshot::RegisterComponentClass<CameraComponent>();
+
 CameraComponent::CameraComponent(TransformableObject& owner, const ComponentTemplate<CameraComponent>& creationTemplate) :
 	GameObjectComponent(owner)
 {
 }
 
-glm::mat4 CameraComponent::GetViewTransform() const
+glm::mat4 CameraComponent::GetViewTransform(f32 interpolationAlpha) const
+{
+	return glm::inverse(mOwner.GetInterpolatedTransform(interpolationAlpha).Matrix());
+}
+
+void CameraComponent::SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const
+{
+}
+
+void CameraComponent::LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader)
 {
-	return glm::inverse(mOwner.Transform.Matrix());
+	GameObject::CreateComponent(owner, ComponentTemplate<CameraComponent>());
 }
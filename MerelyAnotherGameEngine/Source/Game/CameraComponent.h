@@ -13,5 +13,13 @@ class CameraComponent : public GameObjectComponent<TransformableObject>
 public:
 	CameraComponent(TransformableObject& owner, const ComponentTemplate<CameraComponent>& creationTemplate);
 
-	glm::mat4 GetViewTransform() const;
+	static constexpr cstr cSnapshotName = "Camera";
+
+	struct SnapshotData {};
+
+	void SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const;
+	static void LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader);
+
+	// Follows the owner's interpolated transform, like the meshes rendered with it.
+	glm::mat4 GetViewTransform(f32 interpolationAlpha) const;
 };
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <bit>
+#include <mutex>
+#include <new>
+
+// One pool per component class, shared by every world in the process. Creating and destroying
+// components is safe from several threads.
+template<typename ComponentClass>
+class ComponentPool : public NonCopyableClass
+{
+public:
+	static constexpr u32 cChunkCapacity = 64;
+
+	static ComponentPool& Get()
+	{
+		static ComponentPool sPool;
+		return sPool;
+	}
+
+	~ComponentPool()
+	{
+		for (Chunk* chunk : mChunks)
+			delete chunk;
+	}
+
+	template<typename... Args>
+	ComponentClass& Create(u32& outIndex, Args&&... args)
+	{
+		Chunk* chunk = nullptr;
+		u32 slot = 0;
+
+		// Only claim the slot under the lock; the constructor may create further components.
+		{
+			std::lock_guard lock(mMutex);
+
+			while (mFirstFreeChunk < mChunks.GetSize() && mChunks[mFirstFreeChunk]->OccupiedMask == cFullMask)
+				++mFirstFreeChunk;
+
+			if (mFirstFreeChunk == mChunks.GetSize())
+				mChunks.Add(new Chunk());
+
+			chunk = mChunks[mFirstFreeChunk];
+			slot = u32(std::countr_one(chunk->OccupiedMask));
+			chunk->OccupiedMask |= u64(1) << slot;
+
+			outIndex = mFirstFreeChunk * cChunkCapacity + slot;
+		}
+
+		return *new (chunk->GetSlot(slot)) ComponentClass(std::forward<Args>(args)...);
+	}
+
+	// Adds chunks until count more components fit, so that creating them does not allocate.
+	void Reserve(u32 count)
+	{
+		std::lock_guard lock(mMutex);
+
+		u32 freeCount = 0;
+		for (u32 i = mFirstFreeChunk; i < mChunks.GetSize(); ++i)
+			freeCount += u32(std::popcount(~mChunks[i]->OccupiedMask));
+
+		for (; freeCount < count; freeCount += cChunkCapacity)
+			mChunks.Add(new Chunk());
+	}
+
+	void Destroy(u32 index)
+	{
+		const u32 chunkIndex = index / cChunkCapacity;
+		const u32 slot = index % cChunkCapacity;
+
+		Chunk* chunk = nullptr;
+		{
+			std::lock_guard lock(mMutex);
+			chunk = mChunks[chunkIndex];
+			mage_check(chunk->OccupiedMask & (u64(1) << slot));
+		}
+
+		// The slot stays claimed until destroyed, so the destructor can run unlocked.
+		chunk->GetSlot(slot)->~ComponentClass();
+
+		std::lock_guard lock(mMutex);
+		chunk->OccupiedMask &= ~(u64(1) << slot);
+
+		mFirstFreeChunk = std::min(mFirstFreeChunk, chunkIndex);
+	}
+
+private:
+	ComponentPool() {}
+
+	// Components never move once created since other code keeps references to them,
+	// so the pool grows by whole chunks and reuses freed slots in place.
+	struct Chunk
+	{
+		ComponentClass* GetSlot(u32 slot) { return std::launder(reinterpret_cast<ComponentClass*>(Storage)) + slot; }
+
+		u64 OccupiedMask = 0;
+		alignas(ComponentClass) u8 Storage[cChunkCapacity * sizeof(ComponentClass)];
+	};
+
+	static constexpr u64 cFullMask = ~u64(0);
+
+	std::mutex mMutex;
+	mage::Array<Chunk*> mChunks;
+	u32 mFirstFreeChunk = 0;
+};
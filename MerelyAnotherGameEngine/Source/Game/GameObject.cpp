@@ -1,13 +1,23 @@
 #include "Game/GameObject.h"
 #include "Game/GameObjectComponent.h"
 
+#include <atomic>
+
+GameObject::~GameObject()
+{
+	for (const ComponentInstance& instance : mComponents)
+	{
+		instance.ClassInfo->Destroy(instance.PoolIndex);
+	}
+}
+
 void GameObject::OnAddedToWorld(GameWorld& world)
 {
 	mWorld = &world;
 
-	for (const std::shared_ptr<GameObjectComponentBase>& component : mComponents)
+	for (const ComponentInstance& instance : mComponents)
 	{
-		component->OnOwnerAddedToWorld(world);
+		instance.Component->OnOwnerAddedToWorld(world);
 	}
 }
 
@@ -16,24 +26,36 @@ void GameObject::OnRemovedFromWorld(GameWorld& world)
 	mage_check(&world == mWorld);
 	mWorld = nullptr;
 
-	for (const std::shared_ptr<GameObjectComponentBase>& component : mComponents)
+	for (const ComponentInstance& instance : mComponents)
 	{
-		component->OnOwnerRemovedFromWorld(world);
+		instance.Component->OnOwnerRemovedFromWorld(world);
 	}
 }
 
-void GameObject::UpdatePrePhysics(f32 deltaTime)
+void GameObject::OnContact(const ContactEvent& event)
 {
-	for (const std::shared_ptr<GameObjectComponentBase>& component : mComponents)
+	for (const ComponentInstance& instance : mComponents)
 	{
-		component->UpdatePrePhysics(deltaTime);
+		instance.Component->OnOwnerContact(event);
 	}
 }
 
-void GameObject::UpdatePostPhysics(f32 deltaTime)
+void GameObject::OnTrigger(const TriggerEvent& event)
 {
-	for (const std::shared_ptr<GameObjectComponentBase>& component : mComponents)
+	for (const ComponentInstance& instance : mComponents)
 	{
-		component->UpdatePostPhysics(deltaTime);
+		instance.Component->OnOwnerTrigger(event);
 	}
 }
+
+u32 GameObject::AllocateComponentClassId()
+{
+	static std::atomic<u32> sComponentClassCount = 0;
+	return sComponentClassCount++;
+}
+
+u64 GameObject::AllocateSerial()
+{
+	static std::atomic<u64> sSerialCount = 0;
+	return sSerialCount.fetch_add(1, std::memory_order_relaxed);
+}
@@ -1,75 +1,246 @@
 #pragma once
 
+#include "Game/ComponentPool.h"
 #include "Game/GameObjectCommon.h"
+#include "Game/GameObjectComponent.h"
 
-#include <map>
-#include <memory>
-#include <typeindex>
-#include <vector>
+#include <atomic>
+#include <optional>
 
-class GameObjectComponentBase;
 class GameWorld;
+class TransformableObject;
 
 class GameObject : public NonCopyableClass
 {
+	friend class RigidBodyObjectComponent;
+	friend class WorldRollback;
+	friend class WorldSnapshot;
 	friend GameWorld;
 
 public:
+	GameObject() = default;
+	~GameObject();
+
 	template<GameObjectClass ObjectClass, GameObjectComponentClass ComponentClass>
 	static ComponentClass& CreateComponent(ObjectClass& owner, const ComponentTemplate<ComponentClass>& creationTemplate)
 	{
-		std::unique_ptr<ComponentClass> component = std::make_unique<ComponentClass>(owner, creationTemplate);
-		ComponentClass& componentRef = *component.get();
+		ComponentInstance instance;
+		ComponentClass& component = ComponentPool<ComponentClass>::Get().Create(instance.PoolIndex, owner, creationTemplate);
 
-		const u64 index = owner.mComponents.size();
-		owner.mComponents.push_back(std::move(component));
-		owner.mComponentsByClass[typeid(ComponentClass)].push_back(index);
+		instance.Component = &component;
+		instance.ClassInfo = &GetComponentClassInfo<ComponentClass>();
+		owner.mComponents.Add(instance);
 
-		return componentRef;
+		return component;
 	}
 
 	template<GameObjectComponentClass ComponentClass>
-	std::vector<std::shared_ptr<ComponentClass>> GetComponentsOfClass()
+	mage::Array<ComponentClass*> GetComponentsOfClass() const
 	{
-		std::vector<std::shared_ptr<ComponentClass>> result;
-
-		auto componentArray = mComponentsByClass.find(typeid(ComponentClass));
+		mage::Array<ComponentClass*> result;
+		ComponentClassInfo const* classInfo = &GetComponentClassInfo<ComponentClass>();
 
-		if (componentArray == mComponentsByClass.end())
-			return result;
-
-		for (u64 index : componentArray->second)
-			result.push_back(std::reinterpret_pointer_cast<ComponentClass>(mComponents[index]));
+		for (ComponentInstance const& instance : mComponents)
+			if (instance.ClassInfo == classInfo)
+				result.Add(static_cast<ComponentClass*>(instance.Component));
 
 		return result;
 	}
 
+	template<GameObjectComponentClass ComponentClass>
+	static ComponentClassInfo const& GetComponentClassInfo()
+	{
+		static const ComponentClassInfo sClassInfo
+		{
+			.Id = AllocateComponentClassId(),
+			.UpdateGroup = GetComponentUpdateGroup<ComponentClass>(),
+			.UpdateAccess = GetComponentUpdateAccess<ComponentClass>(),
+			.Destroy = [](u32 poolIndex) { ComponentPool<ComponentClass>::Get().Destroy(poolIndex); },
+			.UpdatePrePhysics = GetUpdatePrePhysicsFunction<ComponentClass>(),
+			.UpdatePostPhysics = GetUpdatePostPhysicsFunction<ComponentClass>(),
+			.Snapshot = GetComponentSnapshotInfo<ComponentClass>(),
+			.Rollback = GetComponentRollbackInfo<ComponentClass>()
+		};
+
+		return sClassInfo;
+	}
+
 	bool IsDestroyed() const { return mIsDestoryed; }
 	void Destroy() { mIsDestoryed = true; }
 
 	GameWorld* GetWorld() const { return mWorld; }
 
+	// Whether the object is a TransformableObject, as GameObject has no vtable to ask.
+	bool IsTransformable() const { return mIsTransformable; }
+
+	// Unique to the object for the life of the process, unlike its address, which a later object may reuse.
+	u64 GetSerial() const { return mSerial; }
+
 protected:
+	explicit GameObject(bool isTransformable) : mIsTransformable(isTransformable) {}
+
 	void OnAddedToWorld(GameWorld& world);
 
 	void OnRemovedFromWorld(GameWorld& world);
-	
-	void UpdatePrePhysics(f32 deltaTime);
 
-	void UpdatePostPhysics(f32 deltaTime);
+	void OnContact(const ContactEvent& event);
+
+	void OnTrigger(const TriggerEvent& event);
 
 private:
+	struct ComponentInstance
+	{
+		GameObjectComponentBase* Component;
+		ComponentClassInfo const* ClassInfo;
+		u32 PoolIndex;
+		u32 WorldIndex;
+	};
+
+	static u32 AllocateComponentClassId();
+
+	static u64 AllocateSerial();
+
+	template<GameObjectComponentClass ComponentClass>
+	static constexpr ComponentUpdateGroup GetComponentUpdateGroup()
+	{
+		if constexpr (requires { ComponentClass::cUpdateGroup; })
+			return ComponentClass::cUpdateGroup;
+		else
+			return ComponentUpdateGroup::Default;
+	}
+
+	template<GameObjectComponentClass ComponentClass>
+	static constexpr ComponentUpdateAccess GetComponentUpdateAccess()
+	{
+		if constexpr (requires { ComponentClass::cUpdateAccess; })
+			return ComponentClass::cUpdateAccess;
+		else
+			return ComponentUpdateAccess::World;
+	}
+
+	// Update phases are only scheduled for classes which override them. The calls below go through
+	// the concrete class, so they are resolved statically for overrides marked final.
+	template<GameObjectComponentClass ComponentClass>
+	static constexpr ComponentUpdateFunction GetUpdatePrePhysicsFunction()
+	{
+		if constexpr (std::is_same_v<decltype(&ComponentClass::UpdatePrePhysics), decltype(&GameObjectComponentBase::UpdatePrePhysics)>)
+			return nullptr;
+		else
+			return [](const WorldComponent* components, u32 count, f32 deltaTime)
+				{
+					for (u32 i = 0; i < count; ++i)
+						if (!components[i].Owner->mIsDestoryed)
+							static_cast<ComponentClass*>(components[i].Component)->UpdatePrePhysics(deltaTime);
+				};
+	}
+
+	template<GameObjectComponentClass ComponentClass>
+	static constexpr ComponentUpdateFunction GetUpdatePostPhysicsFunction()
+	{
+		if constexpr (std::is_same_v<decltype(&ComponentClass::UpdatePostPhysics), decltype(&GameObjectComponentBase::UpdatePostPhysics)>)
+			return nullptr;
+		else
+			return [](const WorldComponent* components, u32 count, f32 deltaTime)
+				{
+					for (u32 i = 0; i < count; ++i)
+						if (!components[i].Owner->mIsDestoryed)
+							static_cast<ComponentClass*>(components[i].Component)->UpdatePostPhysics(deltaTime);
+				};
+	}
+
+	// Classes opt into snapshots by declaring a trivially copyable SnapshotData, a cSnapshotName which
+	// stays the same across builds, SaveSnapshot and a static LoadSnapshot, and optionally RestoreSnapshot.
+	template<GameObjectComponentClass ComponentClass>
+	static ComponentSnapshotInfo const* GetComponentSnapshotInfo()
+	{
+		if constexpr (requires { typename ComponentClass::SnapshotData; })
+		{
+			using Data = typename ComponentClass::SnapshotData;
+			using Owner = typename ComponentClass::OwnerType;
+			static_assert(std::is_trivially_copyable_v<Data> && alignof(Data) <= 8);
+
+			static const ComponentSnapshotInfo sSnapshotInfo
+			{
+				.Name = ComponentClass::cSnapshotName,
+				.DataSize = sizeof(Data),
+				.NeedsTransformableOwner = std::is_base_of_v<TransformableObject, Owner>,
+				.Save = [](const GameObjectComponentBase& component, void* data, WorldSnapshotWriter& writer)
+					{ static_cast<const ComponentClass&>(component).SaveSnapshot(*static_cast<Data*>(data), writer); },
+				.Load = [](GameObject& owner, const void* data, WorldSnapshotReader& reader)
+					{ ComponentClass::LoadSnapshot(static_cast<Owner&>(owner), *static_cast<const Data*>(data), reader); },
+				.Restore = GetSnapshotRestoreFunction<ComponentClass>(),
+				.Reserve = [](u32 count) { ComponentPool<ComponentClass>::Get().Reserve(count); }
+			};
+
+			return &sSnapshotInfo;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+
+	template<GameObjectComponentClass ComponentClass>
+	static constexpr auto GetSnapshotRestoreFunction() -> void (*)(GameObjectComponentBase&, const void*)
+	{
+		if constexpr (requires { &ComponentClass::RestoreSnapshot; })
+			return [](GameObjectComponentBase& component, const void* data)
+				{ static_cast<ComponentClass&>(component).RestoreSnapshot(*static_cast<const typename ComponentClass::SnapshotData*>(data)); };
+		else
+			return nullptr;
+	}
+
+	// Classes opt into rollback by declaring a trivially copyable RollbackState with SaveRollbackState
+	// and RestoreRollbackState. Only what changes during updates belongs there, as it is copied every frame.
+	template<GameObjectComponentClass ComponentClass>
+	static ComponentRollbackInfo const* GetComponentRollbackInfo()
+	{
+		if constexpr (requires { typename ComponentClass::RollbackState; })
+		{
+			using State = typename ComponentClass::RollbackState;
+			static_assert(std::is_trivially_copyable_v<State> && alignof(State) <= 8);
+
+			static const ComponentRollbackInfo sRollbackInfo
+			{
+				.StateSize = sizeof(State),
+				.Save = [](const GameObjectComponentBase& component, void* state)
+					{ static_cast<const ComponentClass&>(component).SaveRollbackState(*static_cast<State*>(state)); },
+				.Restore = [](GameObjectComponentBase& component, const void* state)
+					{ static_cast<ComponentClass&>(component).RestoreRollbackState(*static_cast<const State*>(state)); }
+			};
+
+			return &sRollbackInfo;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+
 	GameWorld* mWorld = nullptr;
 
-	std::vector<std::shared_ptr<GameObjectComponentBase>> mComponents;
+	mage::Array<ComponentInstance> mComponents;
 
-	std::map<std::type_index, std::vector<u64>> mComponentsByClass;
+	std::atomic<bool> mIsDestoryed = false;
 
-	bool mIsDestoryed = false;
+	bool mIsTransformable = false;
+
+	u64 mSerial = AllocateSerial();
 };
 
 class TransformableObject : public GameObject
 {
 public:
+	TransformableObject() : GameObject(true) {}
+
+	// Transform between the last two fixed steps, alpha being the fraction of a step elapsed since
+	// the latest one. Objects without a previous transform are not interpolated.
+	mage::Transform GetInterpolatedTransform(f32 alpha) const
+	{
+		return PreviousTransform ? mage::Transform::Interpolate(*PreviousTransform, Transform, alpha) : Transform;
+	}
+
 	mage::Transform Transform;
+
+	std::optional<mage::Transform> PreviousTransform;
 };
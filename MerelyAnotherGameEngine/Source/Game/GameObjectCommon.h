@@ -3,6 +3,48 @@
 
 class GameObject;
 class GameObjectComponentBase;
+class WorldSnapshotReader;
+class WorldSnapshotWriter;
+
+struct WorldComponent
+{
+	GameObjectComponentBase* Component;
+	GameObject* Owner;
+	u32 OwnerIndex;
+};
+
+enum class ContactEventType : u8
+{
+	Begin,
+	End
+};
+
+struct ContactEvent
+{
+	ContactEventType Type;
+
+	GameObject* Other;
+
+	// The normal points from the other object towards the owner.
+	glm::vec3 Position;
+	glm::vec3 Normal;
+};
+
+enum class TriggerEventType : u8
+{
+	Enter,
+	Leave
+};
+
+struct TriggerEvent
+{
+	TriggerEventType Type;
+
+	GameObject* Other;
+
+	// Whether the owner is the trigger, as opposed to the object entering or leaving it.
+	bool IsOwnTrigger;
+};
 
 template<typename T>
 concept GameObjectClass = std::is_base_of<GameObject, T>::value;
@@ -12,3 +54,73 @@ concept GameObjectComponentClass = std::is_base_of<GameObjectComponentBase, T>::
 
 template<typename ComponentClass>
 struct ComponentTemplate {};
+
+// Components in the Default group are updated before PhysicsSync ones ahead of the physics step
+// and after them following it, so the latter always see the latest state on both sides.
+enum class ComponentUpdateGroup : u8
+{
+	Default,
+	PhysicsSync
+};
+
+// Components which only read and write their owner during updates can be updated in parallel.
+// World-wide effects like AddObject and Destroy are deferred, so they remain allowed.
+enum class ComponentUpdateAccess : u8
+{
+	World,
+	OwnerOnly
+};
+
+using ComponentUpdateFunction = void (*)(const WorldComponent* components, u32 count, f32 deltaTime);
+
+// How a component class is written to and read from world snapshots, see WorldSnapshot.h.
+struct ComponentSnapshotInfo
+{
+	cstr Name;
+
+	u32 DataSize;
+
+	bool NeedsTransformableOwner;
+
+	void (*Save)(const GameObjectComponentBase& component, void* data, WorldSnapshotWriter& writer);
+
+	// Creates the component on the owner, which is not in a world yet.
+	void (*Load)(GameObject& owner, const void* data, WorldSnapshotReader& reader);
+
+	// Optional, for state which is only set up once the owner is in a world.
+	void (*Restore)(GameObjectComponentBase& component, const void* data);
+
+	// Makes room in the class's pool, before a load creates that many components.
+	void (*Reserve)(u32 count);
+};
+
+// How a component class keeps the state it changes while updating in rollback frames, see WorldRollback.h.
+struct ComponentRollbackInfo
+{
+	u32 StateSize;
+
+	void (*Save)(const GameObjectComponentBase& component, void* state);
+
+	void (*Restore)(GameObjectComponentBase& component, const void* state);
+};
+
+struct ComponentClassInfo
+{
+	u32 Id;
+
+	ComponentUpdateGroup UpdateGroup;
+
+	ComponentUpdateAccess UpdateAccess;
+
+	void (*Destroy)(u32 poolIndex);
+
+	ComponentUpdateFunction UpdatePrePhysics;
+
+	ComponentUpdateFunction UpdatePostPhysics;
+
+	// Null for classes which cannot be snapshotted.
+	ComponentSnapshotInfo const* Snapshot;
+
+	// Null for classes without state of their own to roll back.
+	ComponentRollbackInfo const* Rollback;
+};
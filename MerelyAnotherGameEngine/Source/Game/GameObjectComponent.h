@@ -17,6 +17,11 @@ protected:
 	virtual void UpdatePrePhysics(f32 deltaTime) {}
 
 	virtual void UpdatePostPhysics(f32 deltaTime) {}
+
+	// Delivered once per step after physics results are fetched, before post-physics updates.
+	virtual void OnOwnerContact(const ContactEvent& event) {}
+
+	virtual void OnOwnerTrigger(const TriggerEvent& event) {}
 };
 
 template<GameObjectClass OwnerClass>
@@ -25,6 +30,8 @@ class GameObjectComponent : public GameObjectComponentBase
 	friend GameObject;
 
 public:
+	using OwnerType = OwnerClass;
+
 	GameObjectComponent(OwnerClass& owner) : mOwner(owner) {}
 
 protected:
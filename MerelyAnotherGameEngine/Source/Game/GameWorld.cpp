@@ -1,3 +1,4 @@
+#include "Core/JobSystem.h"
 #include "Game/CameraComponent.h"
 #include "Game/GameObject.h"
 #include "Game/GameWorld.h"
@@ -5,6 +6,7 @@
 #include "Game/SpriteObjectComponent.h"
 #include "Game/StaticMeshObjectComponent.h"
 #include "Game/TextObjectComponent.h"
+#include "Game/WorldRollback.h"
 #include "Physics/PhysicsSystem.h"
 #include "Rendering/Systems/MeshRenderSystem.h"
 #include "Rendering/Systems/SpriteRenderSystem.h"
@@ -23,46 +25,103 @@ GameWorld::GameWorld(
 	mSpriteRenderSystem(std::move(spriteRenderSystem)),
 	mTextRenderSystem(std::move(textRenderSystem))
 {
+	mage_check(mInputSystem && mPhysicsSystem);
+
+	// Render systems come all together or not at all.
+	mage_check(!mMeshRenderSystem == !mSpriteRenderSystem && !mMeshRenderSystem == !mTextRenderSystem);
 }
 
-void GameWorld::Update(f32 deltaTime)
+GameWorld::GameWorld(std::unique_ptr<PhysicsSystem>&& physicsSystem) :
+	GameWorld(std::make_unique<InputSystem>(), std::move(physicsSystem), nullptr, nullptr, nullptr)
 {
-	mIsCurrentlyUpdatingObjects = true;
-	for (const std::shared_ptr<GameObject>& object : mObjects)
-	{
-		if (object->mIsDestoryed)
-			continue;
+}
 
-		object->UpdatePrePhysics(deltaTime);
-	}
+GameWorld::~GameWorld()
+{
+	// Components must not run into a simulation which is still using their actors.
+	SyncPhysics();
+}
 
-	mIsCurrentlyUpdatingObjects = false;
-	for (std::shared_ptr<GameObject>& newObject : mNewObjects)
+void GameWorld::Update(f32 deltaTime)
+{
+	if (mFixedStepTime <= 0.0f)
 	{
-		newObject->UpdatePrePhysics(deltaTime);
-		mObjects.push_back(std::move(newObject));
+		Step(deltaTime);
 	}
-	mNewObjects.clear();
+	else
+	{
+		mAccumulatedTime += deltaTime;
 
-	mPhysicsSystem->Update(deltaTime);
+		u32 stepCount = 0;
+		while (mAccumulatedTime >= mFixedStepTime && stepCount < mMaxStepsPerUpdate)
+		{
+			Step(mFixedStepTime);
+			mAccumulatedTime -= mFixedStepTime;
+			++stepCount;
+		}
 
-	mIsCurrentlyUpdatingObjects = true;
-	for (const std::shared_ptr<GameObject>& object : mObjects)
-	{
-		if (object->mIsDestoryed)
-			continue;
+		// After a hitch, let the simulation fall behind rather than spiral into ever more steps. Only
+		// whole steps are dropped, so the leftover fraction, and with it interpolation, carries on.
+		if (mAccumulatedTime >= mFixedStepTime)
+			mAccumulatedTime = std::fmod(mAccumulatedTime, mFixedStepTime);
 
-		object->UpdatePostPhysics(deltaTime);
+		mInterpolationAlpha = mAccumulatedTime / mFixedStepTime;
 	}
 
-	mIsCurrentlyUpdatingObjects = false;
-	for (std::shared_ptr<GameObject>& newObject : mNewObjects)
-	{
-		newObject->UpdatePostPhysics(deltaTime);
-		mObjects.push_back(std::move(newObject));
-	}
-	mNewObjects.clear();
+	if (mRollback)
+		mRollback->Capture();
+}
+
+void GameWorld::SetFixedTimestep(f32 stepTime, u32 maxStepsPerUpdate)
+{
+	mage_check(stepTime >= 0.0f && maxStepsPerUpdate > 0);
+
+	mFixedStepTime = stepTime;
+	mMaxStepsPerUpdate = maxStepsPerUpdate;
+	mAccumulatedTime = 0.0f;
+	mInterpolationAlpha = 1.0f;
+}
+
+void GameWorld::SetAsyncPhysics(bool isAsync)
+{
+	mage_check(!isAsync || mRollback == nullptr);
+
+	if (!isAsync)
+		SyncPhysics();
+
+	mIsAsyncPhysics = isAsync;
+}
+
+void GameWorld::SyncPhysics()
+{
+	if (!mPhysicsSystem->IsSimulating())
+		return;
+
+	mPhysicsSystem->EndSimulation();
+
+	UpdateComponents(mPostPhysicsClasses, &ComponentClassInfo::UpdatePostPhysics, mSimulatingDeltaTime);
 
+	RemoveDestroyedObjects();
+
+	// Objects added while the simulation was running could not create their physics actors yet.
+	AddNewObjects();
+}
+
+void GameWorld::Step(f32 deltaTime)
+{
+	SyncPhysics();
+
+	UpdateComponents(mPrePhysicsClasses, &ComponentClassInfo::UpdatePrePhysics, deltaTime);
+
+	mPhysicsSystem->BeginSimulation(deltaTime);
+	mSimulatingDeltaTime = deltaTime;
+
+	if (!mIsAsyncPhysics)
+		SyncPhysics();
+}
+
+void GameWorld::RemoveDestroyedObjects()
+{
 	u64 currentObject = 0;
 	u64 destroyedObjectCount = 0;
 	const u64 totalObjectCount = mObjects.size();
@@ -74,6 +133,9 @@ void GameWorld::Update(f32 deltaTime)
 			std::swap(mObjects[currentObject], mObjects[totalObjectCount - destroyedObjectCount - 1]);
 			destroyedObjectCount++;
 
+			if (mRollback)
+				mRollback->OnObjectRemoved(mObjects[totalObjectCount - destroyedObjectCount]);
+
 			RemoveObject(mObjects[totalObjectCount - destroyedObjectCount]);
 		}
 		else
@@ -104,6 +166,9 @@ glm::mat4 CalcProjectionTransform(f32 nearPlane, f32 farPlane, f32 horizontalFOV
 
 void GameWorld::Render(Vulkan::Renderer& renderer) const
 {
+	if (IsHeadless())
+		return;
+
 	SceneRenderData sceneData;
 	mage::Array<SpriteRenderData> spriteData;
 	mage::Array<TextRenderData> textData;
@@ -111,39 +176,39 @@ void GameWorld::Render(Vulkan::Renderer& renderer) const
 	sceneData.LightDirection = glm::vec3(-3.0f, 2.0f, -2.5f);
 	sceneData.AmbientLightIntensity = 0.05f;
 
-	bool foundCamera = false;
-	for (std::shared_ptr<GameObject> const& object : mObjects)
-	{
-		for (std::shared_ptr<StaticMeshObjectComponent> const& staticMeshComp : object->GetComponentsOfClass<StaticMeshObjectComponent>())
+	sceneData.Meshes.Reserve(GetComponentCount<StaticMeshObjectComponent>());
+	ForEach<StaticMeshObjectComponent>([this, &sceneData](StaticMeshObjectComponent const& staticMeshComp)
+		{
 			sceneData.Meshes.AddConstruct(
-				staticMeshComp->GetTransform().Matrix(),
-				staticMeshComp->GetMesh(),
-				staticMeshComp->GetTexture());
+				staticMeshComp.GetInterpolatedTransform(mInterpolationAlpha).Matrix(),
+				staticMeshComp.GetMesh(),
+				staticMeshComp.GetTexture());
+		});
 
-		for (std::shared_ptr<SpriteObjectComponent> const& spriteComp : object->GetComponentsOfClass<SpriteObjectComponent>())
+	spriteData.Reserve(GetComponentCount<SpriteObjectComponent>());
+	ForEach<SpriteObjectComponent>([&spriteData](SpriteObjectComponent const& spriteComp)
+		{
 			spriteData.AddConstruct(
-				spriteComp->GetScreenCoordsMin(),
-				spriteComp->GetScreenCoordsMax(),
-				spriteComp->GetTextureCoordsMin(),
-				spriteComp->GetTextureCoordsMax(),
-				spriteComp->GetTexture());
+				spriteComp.GetScreenCoordsMin(),
+				spriteComp.GetScreenCoordsMax(),
+				spriteComp.GetTextureCoordsMin(),
+				spriteComp.GetTextureCoordsMax(),
+				spriteComp.GetTexture());
+		});
 
-		for (std::shared_ptr<TextObjectComponent> const& textComp : object->GetComponentsOfClass<TextObjectComponent>())
+	textData.Reserve(GetComponentCount<TextObjectComponent>());
+	ForEach<TextObjectComponent>([&textData](TextObjectComponent const& textComp)
+		{
 			textData.AddConstruct(
-				textComp->GetText(),
-				textComp->GetColor(),
-				textComp->GetScreenPosition(),
-				textComp->GetScale(),
-				textComp->GetFont());
-
-		if (!foundCamera)
-			for (std::shared_ptr<CameraComponent> const& cameraComp : object->GetComponentsOfClass<CameraComponent>())
-			{
-				sceneData.ViewTransform = cameraComp->GetViewTransform();
-				foundCamera = true;
-				break;
-			}
-	}
+				textComp.GetText(),
+				textComp.GetColor(),
+				textComp.GetScreenPosition(),
+				textComp.GetScale(),
+				textComp.GetFont());
+		});
+
+	if (mActiveCamera)
+		sceneData.ViewTransform = mActiveCamera->GetViewTransform(mInterpolationAlpha);
 
 	renderer.RenderFrame([this, &sceneData, &spriteData, &textData](Vulkan::RenderFrameData const& inFrameData)
 		{
@@ -158,15 +223,194 @@ void GameWorld::Render(Vulkan::Renderer& renderer) const
 
 void GameWorld::AddObject(const std::shared_ptr<GameObject>& object)
 {
-	if (mIsCurrentlyUpdatingObjects)
+	if (mIsCurrentlyUpdatingObjects || mPhysicsSystem->IsSimulating())
+	{
+		std::lock_guard lock(mNewObjectsMutex);
 		mNewObjects.push_back(object);
-	else
-		mObjects.push_back(object);
+		return;
+	}
 
+	mObjects.push_back(object);
+
+	RegisterComponents(*object);
 	object->OnAddedToWorld(*this);
 }
 
+void GameWorld::AddObjects(const std::vector<std::shared_ptr<GameObject>>& objects)
+{
+	if (mIsCurrentlyUpdatingObjects || mPhysicsSystem->IsSimulating())
+	{
+		std::lock_guard lock(mNewObjectsMutex);
+		mNewObjects.insert(mNewObjects.end(), objects.begin(), objects.end());
+		return;
+	}
+
+	mObjects.reserve(mObjects.size() + objects.size());
+
+	// Count each class's new components, registering the classes on the way.
+	mage::Array<u32> newComponentCounts;
+
+	for (const std::shared_ptr<GameObject>& object : objects)
+	{
+		for (const GameObject::ComponentInstance& instance : object->mComponents)
+		{
+			RegisterComponentClass(*instance.ClassInfo);
+
+			if (instance.ClassInfo->Id >= newComponentCounts.GetSize())
+				newComponentCounts.ResizeDefault(instance.ClassInfo->Id + 1);
+
+			++newComponentCounts[instance.ClassInfo->Id];
+		}
+	}
+
+	for (u32 i = 0; i < newComponentCounts.GetSize(); ++i)
+		if (newComponentCounts[i] > 0)
+			mComponentsByClass[i].Reserve(mComponentsByClass[i].GetSize() + newComponentCounts[i], false);
+
+	for (const std::shared_ptr<GameObject>& object : objects)
+	{
+		mObjects.push_back(object);
+
+		RegisterComponents(*object);
+		object->OnAddedToWorld(*this);
+	}
+}
+
 void GameWorld::RemoveObject(const std::shared_ptr<GameObject>& object)
 {
 	object->OnRemovedFromWorld(*this);
+	UnregisterComponents(*object);
+}
+
+const mage::Array<WorldComponent>* GameWorld::FindComponentList(const ComponentClassInfo& classInfo) const
+{
+	return classInfo.Id < mComponentsByClass.GetSize() ? &mComponentsByClass[classInfo.Id] : nullptr;
+}
+
+void GameWorld::UpdateComponents(const mage::Array<ComponentClassInfo const*>& classes, ComponentUpdateFunction ComponentClassInfo::* update, f32 deltaTime)
+{
+	mIsUpdatingPhase = true;
+
+	for (u32 i = 0; i < classes.GetSize(); ++i)
+	{
+		const ComponentClassInfo* classInfo = classes[i];
+		const mage::Array<WorldComponent>& components = mComponentsByClass[classInfo->Id];
+
+		const ComponentUpdateFunction updateFunction = classInfo->*update;
+
+		mIsCurrentlyUpdatingObjects = true;
+
+		if (mParallelUpdateJobSystem && classInfo->UpdateAccess == ComponentUpdateAccess::OwnerOnly && components.GetSize() > cParallelUpdateBatchSize)
+		{
+			mParallelUpdateJobSystem->ParallelForRange(components.GetSize(), cParallelUpdateBatchSize, [&components, updateFunction, deltaTime](u32 begin, u32 end)
+				{
+					updateFunction(components.GetData() + begin, end - begin, deltaTime);
+				});
+		}
+		else
+		{
+			updateFunction(components.GetData(), components.GetSize(), deltaTime);
+		}
+
+		mIsCurrentlyUpdatingObjects = false;
+
+		AddNewObjects();
+	}
+
+	mIsUpdatingPhase = false;
+
+	for (ComponentClassInfo const* classInfo : mPendingClasses)
+		AddToPhases(*classInfo);
+
+	mPendingClasses.Empty();
+}
+
+void GameWorld::AddNewObjects()
+{
+	for (u64 i = 0; i < mNewObjects.size(); ++i)
+	{
+		const std::shared_ptr<GameObject> object = std::move(mNewObjects[i]);
+		AddObject(object);
+	}
+
+	mNewObjects.clear();
+}
+
+void GameWorld::RegisterComponentClass(const ComponentClassInfo& classInfo)
+{
+	if (classInfo.Id >= mComponentsByClass.GetSize())
+	{
+		mComponentsByClass.ResizeDefault(classInfo.Id + 1);
+		mComponentClasses.ResizeDefault(classInfo.Id + 1);
+	}
+
+	if (mComponentClasses[classInfo.Id] != nullptr)
+		return;
+
+	mComponentClasses[classInfo.Id] = &classInfo;
+
+	if (mIsUpdatingPhase)
+		mPendingClasses.Add(&classInfo);
+	else
+		AddToPhases(classInfo);
+}
+
+void GameWorld::AddToPhases(const ComponentClassInfo& classInfo)
+{
+	auto insertSorted = [&classInfo](mage::Array<ComponentClassInfo const*>& classes, bool physicsSyncFirst)
+		{
+			auto getOrder = [physicsSyncFirst](const ComponentClassInfo* info)
+				{
+					const bool isPhysicsSync = info->UpdateGroup == ComponentUpdateGroup::PhysicsSync;
+					return std::make_pair(isPhysicsSync != physicsSyncFirst, info->Id);
+				};
+
+			u32 index = 0;
+			while (index < classes.GetSize() && getOrder(classes[index]) < getOrder(&classInfo))
+				++index;
+
+			classes.Insert(&classInfo, index);
+		};
+
+	if (classInfo.UpdatePrePhysics)
+		insertSorted(mPrePhysicsClasses, false);
+
+	if (classInfo.UpdatePostPhysics)
+		insertSorted(mPostPhysicsClasses, true);
+}
+
+void GameWorld::RegisterComponents(GameObject& object)
+{
+	for (u32 i = 0; i < object.mComponents.GetSize(); ++i)
+	{
+		GameObject::ComponentInstance& instance = object.mComponents[i];
+
+		RegisterComponentClass(*instance.ClassInfo);
+
+		mage::Array<WorldComponent>& components = mComponentsByClass[instance.ClassInfo->Id];
+		instance.WorldIndex = components.AddConstruct(instance.Component, &object, i);
+
+		if (mActiveCamera == nullptr && instance.ClassInfo == &GameObject::GetComponentClassInfo<CameraComponent>())
+			mActiveCamera = static_cast<CameraComponent const*>(instance.Component);
+	}
+}
+
+void GameWorld::UnregisterComponents(GameObject& object)
+{
+	for (const GameObject::ComponentInstance& instance : object.mComponents)
+	{
+		mage::Array<WorldComponent>& components = mComponentsByClass[instance.ClassInfo->Id];
+		mage_check(components[instance.WorldIndex].Component == instance.Component);
+
+		if (instance.Component == mActiveCamera)
+			mActiveCamera = nullptr;
+
+		components.RemoveAtSwap(instance.WorldIndex);
+
+		if (instance.WorldIndex < components.GetSize())
+		{
+			const WorldComponent& moved = components[instance.WorldIndex];
+			moved.Owner->mComponents[moved.OwnerIndex].WorldIndex = instance.WorldIndex;
+		}
+	}
 }
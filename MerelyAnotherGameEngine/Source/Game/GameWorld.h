@@ -1,14 +1,23 @@
 #pragma once
 
+#include "Game/GameObject.h"
+
 #include <memory>
+#include <mutex>
 #include <vector>
 
-class GameObject;
+class CameraComponent;
 class PhysicsSystem;
 class InputSystem;
 class MeshRenderSystem;
 class SpriteRenderSystem;
 class TextRenderSystem;
+class WorldRollback;
+
+namespace mage
+{
+	class JobSystem;
+}
 
 namespace Vulkan
 {
@@ -17,6 +26,9 @@ namespace Vulkan
 
 class GameWorld : public NonCopyableClass
 {
+	friend class WorldRollback;
+	friend class WorldSnapshot;
+
 public:
 	GameWorld(
 		std::unique_ptr<InputSystem>&& inputSystem,
@@ -25,18 +37,111 @@ public:
 		std::unique_ptr<SpriteRenderSystem>&& spriteRenderSystem,
 		std::unique_ptr<TextRenderSystem>&& textRenderSystem);
 
+	// A headless world: input only comes through InputSystem::InjectKeyEvent and there is nothing
+	// to render with, so it needs neither a window nor a GPU.
+	GameWorld(std::unique_ptr<PhysicsSystem>&& physicsSystem);
+
+	~GameWorld();
+
+	// Advances the world by the time elapsed since the last frame. With a fixed timestep, this runs
+	// as many steps as fit in the accumulated time, up to maxStepsPerUpdate, and drops the rest.
+	// An attached WorldRollback captures the resulting state at the end.
 	void Update(f32 deltaTime);
+	// Does nothing for headless worlds.
 	void Render(Vulkan::Renderer& renderer) const;
 
+	bool IsHeadless() const { return mMeshRenderSystem == nullptr; }
+
+	// With async physics, each step leaves its simulation running when Update returns, so it overlaps
+	// with rendering. It is completed at the start of the next step or by SyncPhysics, after which
+	// the post-physics updates run. Rendering then shows the state one step behind the simulation.
+	// Not available while a WorldRollback is attached, as it captures each update's finished results.
+	void SetAsyncPhysics(bool isAsync);
+
+	// Completes a simulation left running by async physics. Does nothing when none is running.
+	void SyncPhysics();
+
+	// A zero step time goes back to one step of the frame's length per update.
+	void SetFixedTimestep(f32 stepTime, u32 maxStepsPerUpdate);
+
+	// Opts into updating components which declare owner-only access on the given job system.
+	// Passing nullptr goes back to updating everything on the calling thread.
+	void SetParallelUpdateJobSystem(mage::JobSystem* jobSystem) { mParallelUpdateJobSystem = jobSystem; }
+
 	void AddObject(const std::shared_ptr<GameObject>& object);
+
+	// Same as adding each object, with the world's lists grown once for all of them.
+	void AddObjects(const std::vector<std::shared_ptr<GameObject>>& objects);
 	void RemoveObject(const std::shared_ptr<GameObject>& object);
 
+	template<GameObjectComponentClass ComponentClass, typename Function>
+	void ForEach(Function&& function)
+	{
+		const mage::Array<WorldComponent>* components = FindComponentList(GameObject::GetComponentClassInfo<ComponentClass>());
+		if (components == nullptr)
+			return;
+
+		for (u32 i = 0; i < components->GetSize(); ++i)
+			function(*static_cast<ComponentClass*>((*components)[i].Component));
+	}
+
+	template<GameObjectComponentClass ComponentClass, typename Function>
+	void ForEach(Function&& function) const
+	{
+		const mage::Array<WorldComponent>* components = FindComponentList(GameObject::GetComponentClassInfo<ComponentClass>());
+		if (components == nullptr)
+			return;
+
+		for (u32 i = 0; i < components->GetSize(); ++i)
+			function(*static_cast<ComponentClass const*>((*components)[i].Component));
+	}
+
+	// Which component comes first changes as others are removed, so this suits classes with one instance.
+	template<GameObjectComponentClass ComponentClass>
+	ComponentClass* FindFirst() const
+	{
+		const mage::Array<WorldComponent>* components = FindComponentList(GameObject::GetComponentClassInfo<ComponentClass>());
+		if (components == nullptr || components->IsEmpty())
+			return nullptr;
+
+		return static_cast<ComponentClass*>(components->GetFirst().Component);
+	}
+
+	template<GameObjectComponentClass ComponentClass>
+	u32 GetComponentCount() const
+	{
+		const mage::Array<WorldComponent>* components = FindComponentList(GameObject::GetComponentClassInfo<ComponentClass>());
+		return components ? components->GetSize() : 0;
+	}
+
+	// The camera the world renders from. The first camera added to a world becomes its active one,
+	// and removing the active camera leaves the world without one until another is set or added.
+	void SetActiveCamera(CameraComponent const* camera) { mActiveCamera = camera; }
+	CameraComponent const* GetActiveCamera() const { return mActiveCamera; }
+
 	InputSystem& GetInputSystem() const { return *mInputSystem; }
 	PhysicsSystem& GetPhysicsSystem() const { return *mPhysicsSystem; }
 	MeshRenderSystem& GetMeshRenderSystem() const { return *mMeshRenderSystem; }
 	SpriteRenderSystem& GetSpriteRenderSystem() const { return *mSpriteRenderSystem; }
 
 private:
+	// Smallest share of a class's components given to one job when updating in parallel.
+	static constexpr u32 cParallelUpdateBatchSize = 64;
+
+	const mage::Array<WorldComponent>* FindComponentList(const ComponentClassInfo& classInfo) const;
+
+	void Step(f32 deltaTime);
+
+	void UpdateComponents(const mage::Array<ComponentClassInfo const*>& classes, ComponentUpdateFunction ComponentClassInfo::* update, f32 deltaTime);
+
+	void AddNewObjects();
+	void RemoveDestroyedObjects();
+
+	void RegisterComponentClass(const ComponentClassInfo& classInfo);
+	void AddToPhases(const ComponentClassInfo& classInfo);
+	void RegisterComponents(GameObject& object);
+	void UnregisterComponents(GameObject& object);
+
 	std::unique_ptr<InputSystem> mInputSystem;
 	std::unique_ptr<PhysicsSystem> mPhysicsSystem;
 	std::unique_ptr<MeshRenderSystem> mMeshRenderSystem;
@@ -45,6 +150,35 @@ private:
 
 	std::vector<std::shared_ptr<GameObject>> mObjects;
 	std::vector<std::shared_ptr<GameObject>> mNewObjects;
+	std::mutex mNewObjectsMutex;
+
+	// Text of loaded snapshots, which components keep views into.
+	std::vector<std::unique_ptr<char[]>> mSnapshotStrings;
+
+	mage::Array<mage::Array<WorldComponent>> mComponentsByClass;
+	mage::Array<ComponentClassInfo const*> mComponentClasses;
+
+	mage::Array<ComponentClassInfo const*> mPrePhysicsClasses;
+	mage::Array<ComponentClassInfo const*> mPostPhysicsClasses;
+
+	// Classes registered while a phase runs join the phase lists once it is over, so a phase always
+	// updates the classes it started with, whichever position the new ones sort into.
+	mage::Array<ComponentClassInfo const*> mPendingClasses;
+	bool mIsUpdatingPhase = false;
+
+	CameraComponent const* mActiveCamera = nullptr;
+
+	mage::JobSystem* mParallelUpdateJobSystem = nullptr;
+
+	WorldRollback* mRollback = nullptr;
+
+	bool mIsAsyncPhysics = false;
+	f32 mSimulatingDeltaTime = 0.0f;
+
+	f32 mFixedStepTime = 0.0f;
+	u32 mMaxStepsPerUpdate = 1;
+	f32 mAccumulatedTime = 0.0f;
+	f32 mInterpolationAlpha = 1.0f;
 
 	bool mIsCurrentlyUpdatingObjects = false;
 };
@@ -0,0 +1,36 @@
+#include "Core/JobSystem.h"
+#include "Game/GameWorldHost.h"
+#include "Physics/PhysicsSystem.h"
+
+GameWorldHost::GameWorldHost(mage::JobSystem& jobSystem, const PhysicsSystemSettings& physicsSettings) :
+	mJobSystem(jobSystem),
+	mPhysicsContext(jobSystem),
+	mPhysicsSettings(physicsSettings)
+{
+}
+
+GameWorldHost::~GameWorldHost()
+{
+	for (GameWorld* world : mWorlds)
+		delete world;
+}
+
+GameWorld& GameWorldHost::CreateWorld()
+{
+	GameWorld* world = new GameWorld(std::make_unique<PhysicsSystem>(mPhysicsContext, mPhysicsSettings));
+	mWorlds.Add(world);
+
+	return *world;
+}
+
+void GameWorldHost::DestroyWorld(GameWorld& world)
+{
+	if (mWorlds.RemoveSwap(&world))
+		delete &world;
+}
+
+void GameWorldHost::Update(f32 deltaTime)
+{
+	// A world waiting for its simulation helps with other jobs, which may be other worlds' updates.
+	mJobSystem.ParallelFor(mWorlds, [deltaTime](GameWorld* world) { world->Update(deltaTime); }, 1);
+}
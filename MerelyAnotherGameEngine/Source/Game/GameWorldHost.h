@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Game/GameWorld.h"
+#include "Physics/PhysicsContext.h"
+
+// Runs many headless worlds in one process, for dedicated servers and for simulation runs without
+// a GPU. The worlds share one PhysicsContext and are updated in parallel on the job system, one job
+// per world. Assets handed to the worlds must no longer change while they run.
+class GameWorldHost : public NonCopyableClass
+{
+public:
+	GameWorldHost(mage::JobSystem& jobSystem, const PhysicsSystemSettings& physicsSettings = {});
+
+	~GameWorldHost();
+
+	GameWorld& CreateWorld();
+	void DestroyWorld(GameWorld& world);
+
+	// Updates every world by the same time; returns once all of them are done.
+	void Update(f32 deltaTime);
+
+	u32 GetWorldCount() const { return mWorlds.GetSize(); }
+	GameWorld& GetWorld(u32 index) const { return *mWorlds[index]; }
+
+	PhysicsContext& GetPhysicsContext() { return mPhysicsContext; }
+
+private:
+	mage::JobSystem& mJobSystem;
+	PhysicsContext mPhysicsContext;
+	PhysicsSystemSettings mPhysicsSettings;
+
+	mage::Array<GameWorld*> mWorlds;
+};
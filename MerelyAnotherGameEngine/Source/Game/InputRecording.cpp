@@ -0,0 +1,151 @@
+#include "Game/InputRecording.h"
+#include "Game/InputSystem.h"
+
+#include <GLFW/glfw3.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	constexpr u32 cInputFileMagic = 0x4950414d; // "MAPI"
+	constexpr u32 cInputFileVersion = 1;
+
+	template<typename Type>
+	void Write(mage::Array<u8>& data, Type value)
+	{
+		const u32 offset = data.GetSize();
+		data.ResizeUninitialized(offset + sizeof(Type));
+		std::memcpy(data.GetData() + offset, &value, sizeof(Type));
+	}
+}
+
+void InputFrame::Apply(InputSystem& inputSystem) const
+{
+	for (const InputEvent& event : Events)
+	{
+		if (event.Type == InputEventType::Key)
+			inputSystem.InjectKeyEvent(event.Key, event.Action);
+		else
+			inputSystem.InjectCursorMovement(event.CursorMovement, event.CursorMode);
+	}
+}
+
+void InputRecorder::RecordKeyEvent(i32 key, i32 action)
+{
+	Write(mFrameEvents, InputEventType::Key);
+	Write(mFrameEvents, i16(key));
+	Write(mFrameEvents, u8(action));
+	++mFrameEventCount;
+}
+
+void InputRecorder::RecordCursorMovement(glm::dvec2 movement, i32 cursorMode)
+{
+	Write(mFrameEvents, InputEventType::CursorMovement);
+	Write(mFrameEvents, u8(cursorMode - GLFW_CURSOR_NORMAL));
+	Write(mFrameEvents, f32(movement.x));
+	Write(mFrameEvents, f32(movement.y));
+	++mFrameEventCount;
+}
+
+void InputRecorder::EndFrame(f32 deltaTime)
+{
+	mage_ensure(mFrameEventCount <= UINT16_MAX);
+
+	Write(mFrames, deltaTime);
+	Write(mFrames, u16(mFrameEventCount));
+
+	const u32 offset = mFrames.GetSize();
+	mFrames.ResizeUninitialized(offset + mFrameEvents.GetSize());
+	std::memcpy(mFrames.GetData() + offset, mFrameEvents.GetData(), mFrameEvents.GetSize());
+
+	mFrameEvents.Empty();
+	mFrameEventCount = 0;
+	++mFrameCount;
+}
+
+bool InputRecorder::SaveToFile(mage::StringView path) const
+{
+	mage::Array<u8> header;
+	Write(header, cInputFileMagic);
+	Write(header, cInputFileVersion);
+	Write(header, mFrameCount);
+
+	std::ofstream file(path.GetCString(), std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(header.GetData()), header.GetSize());
+	file.write(reinterpret_cast<const char*>(mFrames.GetData()), mFrames.GetSize());
+
+	return file.good();
+}
+
+bool InputReplay::LoadFromFile(mage::StringView path)
+{
+	mData.Empty();
+	mReadOffset = 0;
+	mFrameCount = 0;
+
+	std::error_code error;
+	if (!std::filesystem::is_regular_file(path.GetCString(), error))
+		return false;
+
+	mData = mage::ReadFile(path);
+
+	u32 magic = 0, version = 0;
+	if (!Read(magic) || !Read(version) || !Read(mFrameCount))
+		return false;
+
+	return magic == cInputFileMagic && version == cInputFileVersion;
+}
+
+bool InputReplay::ReadFrame(InputFrame& frame)
+{
+	frame.Events.Empty();
+
+	u16 eventCount = 0;
+	if (!Read(frame.DeltaTime) || !Read(eventCount))
+		return false;
+
+	for (u32 i = 0; i < eventCount; ++i)
+	{
+		InputEvent& event = frame.Events[frame.Events.AddDefault()];
+
+		if (!Read(event.Type))
+			return false;
+
+		if (event.Type == InputEventType::Key)
+		{
+			i16 key = 0;
+			u8 action = 0;
+			if (!Read(key) || !Read(action))
+				return false;
+
+			event.Key = key;
+			event.Action = action;
+		}
+		else
+		{
+			u8 cursorMode = 0;
+			f32 movementX = 0.0f, movementY = 0.0f;
+			if (!Read(cursorMode) || !Read(movementX) || !Read(movementY))
+				return false;
+
+			event.CursorMode = GLFW_CURSOR_NORMAL + cursorMode;
+			event.CursorMovement = glm::dvec2(movementX, movementY);
+		}
+	}
+
+	return true;
+}
+
+template<typename Type>
+bool InputReplay::Read(Type& value)
+{
+	if (mReadOffset + sizeof(Type) > mData.GetSize())
+		return false;
+
+	std::memcpy(&value, mData.GetData() + mReadOffset, sizeof(Type));
+	mReadOffset += sizeof(Type);
+
+	return true;
+}
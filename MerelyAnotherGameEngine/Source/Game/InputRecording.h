@@ -0,0 +1,74 @@
+#pragma once
+
+class InputSystem;
+
+enum class InputEventType : u8
+{
+	Key,
+	CursorMovement
+};
+
+struct InputEvent
+{
+	InputEventType Type;
+	i32 Key;
+	i32 Action;
+	glm::dvec2 CursorMovement;
+	i32 CursorMode;
+};
+
+// Input received during one frame, followed by the time the world was updated by.
+struct InputFrame
+{
+	f32 DeltaTime;
+	mage::Array<InputEvent> Events;
+
+	// Feeds the events to the input system as if they came from its window.
+	void Apply(InputSystem& inputSystem) const;
+};
+
+// Captures the input of a session frame by frame. Attach it to an input system with
+// InputSystem::SetRecorder and call EndFrame with the time each world update used.
+//
+// File layout, little endian: magic, version and frame count as u32, then per frame the delta time
+// as f32, the event count as u16 and the events. A key event is its type as u8, the key as i16 and the
+// action as u8. A cursor event is its type as u8, the cursor mode minus GLFW_CURSOR_NORMAL as u8 and
+// the movement as two f32, which holds the whole pixel steps that windows report exactly.
+class InputRecorder : public NonCopyableClass
+{
+public:
+	void RecordKeyEvent(i32 key, i32 action);
+	void RecordCursorMovement(glm::dvec2 movement, i32 cursorMode);
+
+	void EndFrame(f32 deltaTime);
+
+	bool SaveToFile(mage::StringView path) const;
+
+	u32 GetFrameCount() const { return mFrameCount; }
+
+private:
+	mage::Array<u8> mFrames;
+	mage::Array<u8> mFrameEvents;
+	u32 mFrameEventCount = 0;
+	u32 mFrameCount = 0;
+};
+
+// Reads back a file written by InputRecorder one frame at a time.
+class InputReplay : public NonCopyableClass
+{
+public:
+	bool LoadFromFile(mage::StringView path);
+
+	// Returns false after the last frame or if the file is damaged.
+	bool ReadFrame(InputFrame& frame);
+
+	u32 GetFrameCount() const { return mFrameCount; }
+
+private:
+	mage::Array<u8> mData;
+	u32 mReadOffset = 0;
+	u32 mFrameCount = 0;
+
+	template<typename Type>
+	bool Read(Type& value);
+};
@@ -1,18 +1,32 @@
+#include "Game/InputRecording.h"
 #include "Game/InputSystem.h"
 #include "Vulkan/Window.h"
 
-InputSystem::InputSystem(Vulkan::Window& window) : mWindow(window)
+InputSystem::InputSystem(Vulkan::Window& window) : mWindow(&window)
 {
-	mWindow.SetKeyCallback([this](i32 key, i32 scancode, i32 action, i32 mods) { KeyCallback(key, action, mods); });
-	mWindow.SetCursorPositionCallback([this](glm::dvec2 position) { CursorPositionCallback(position); });
+	mWindow->SetKeyCallback([this](i32 key, i32 scancode, i32 action, i32 mods) { KeyCallback(key, action, mods); });
+	mWindow->SetCursorPositionCallback([this](glm::dvec2 position) { CursorPositionCallback(position); });
 
-	mCursorPosition = mWindow.GetCursorPosition();
+	mCursorPosition = mWindow->GetCursorPosition();
 }
 
-i32 InputSystem::GetKeyState(i32 key) { return mWindow.GetKeyState(key); }
+i32 InputSystem::GetKeyState(i32 key) const
+{
+	return key >= 0 && u32(key) < mKeyStates.GetSize() ? mKeyStates[key] : GLFW_RELEASE;
+}
 
 void InputSystem::KeyCallback(i32 key, i32 action, i32 mods)
 {
+	if (mRecorder != nullptr) mRecorder->RecordKeyEvent(key, action);
+
+	if (key >= 0)
+	{
+		if (u32(key) >= mKeyStates.GetSize())
+			mKeyStates.ResizeDefault(key + 1);
+
+		mKeyStates[key] = action == GLFW_REPEAT ? GLFW_PRESS : action;
+	}
+
 	const std::function<void()>& handler = mKeyInputHandlers[std::make_pair(key, action)];
 	if (handler != nullptr) handler();
 }
@@ -20,7 +34,14 @@ void InputSystem::KeyCallback(i32 key, i32 action, i32 mods)
 void InputSystem::CursorPositionCallback(glm::dvec2 position)
 {
 	const glm::dvec2 movement = position - mCursorPosition;
-	if (mCursorMovementHandler != nullptr) mCursorMovementHandler(movement, mWindow.GetCursorInputMode());
-
 	mCursorPosition = position;
+
+	HandleCursorMovement(movement, mWindow->GetCursorInputMode());
+}
+
+void InputSystem::HandleCursorMovement(glm::dvec2 movement, i32 cursorMode)
+{
+	if (mRecorder != nullptr) mRecorder->RecordCursorMovement(movement, cursorMode);
+
+	if (mCursorMovementHandler != nullptr) mCursorMovementHandler(movement, cursorMode);
 }
@@ -2,6 +2,8 @@
 
 #include <map>
 
+class InputRecorder;
+
 namespace Vulkan
 {
 	class Window;
@@ -9,25 +11,43 @@ namespace Vulkan
 
 class InputSystem : public NonCopyableClass
 {
+	friend class WorldRollback;
+
 public:
 	InputSystem(Vulkan::Window& window);
 
+	// Without a window, for headless worlds. Input then only comes from InjectKeyEvent.
+	InputSystem() {}
+
 	~InputSystem() {}
 
-	i32 GetKeyState(i32 key);
+	// Reads the state tracked from key events rather than polling the window, so it is safe to call
+	// from any thread during world updates.
+	i32 GetKeyState(i32 key) const;
 
 	void BindKeyInputHandler(i32 key, i32 action, std::function<void()> handler) { mKeyInputHandlers[std::make_pair(key, action)] = handler; }
 
 	void BindCursorMovementHandler(std::function<void(glm::dvec2, i32)> handler) { mCursorMovementHandler = handler; }
 
+	// Handles a key event as if it came from the window.
+	void InjectKeyEvent(i32 key, i32 action) { KeyCallback(key, action, 0); }
+	void InjectCursorMovement(glm::dvec2 movement, i32 cursorMode) { HandleCursorMovement(movement, cursorMode); }
+
+	// Every event handled from now on, window or injected, is also passed to the recorder.
+	void SetRecorder(InputRecorder* recorder) { mRecorder = recorder; }
+
 private:
-	Vulkan::Window& mWindow;
+	Vulkan::Window* mWindow = nullptr;
+	InputRecorder* mRecorder = nullptr;
+
+	glm::dvec2 mCursorPosition = {};
 
-	glm::dvec2 mCursorPosition;
+	mage::Array<i32> mKeyStates;
 
 	std::map<std::pair<i32, i32>, std::function<void()>> mKeyInputHandlers;
 	std::function<void(glm::dvec2, i32)> mCursorMovementHandler;
 
 	void KeyCallback(i32 key, i32 action, i32 mods);
 	void CursorPositionCallback(glm::dvec2 position);
+	void HandleCursorMovement(glm::dvec2 movement, i32 cursorMode);
 };
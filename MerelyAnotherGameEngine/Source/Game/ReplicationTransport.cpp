@@ -0,0 +1,218 @@
+#include "Game/ReplicationTransport.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <WinSock2.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+	using NativeSocket = SOCKET;
+	using IoSize = int;
+
+	constexpr int cSendFlags = 0;
+
+	bool InitializeSockets()
+	{
+		static const bool sIsInitialized = []()
+			{
+				WSADATA data;
+				return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+			}();
+
+		return sIsInitialized;
+	}
+
+	void CloseSocket(NativeSocket socket) { closesocket(socket); }
+#else
+	using NativeSocket = int;
+	using IoSize = size_t;
+
+	// A viewer which goes away fails the send rather than raising SIGPIPE.
+	constexpr int cSendFlags = MSG_NOSIGNAL;
+
+	bool InitializeSockets() { return true; }
+
+	void CloseSocket(NativeSocket socket) { close(socket); }
+#endif
+
+	// Sends and receives are split so that their sizes fit every platform's size type.
+	constexpr u32 cMaxTransferSize = 1024 * 1024;
+
+	sockaddr_in GetLoopbackAddress(u16 port)
+	{
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		return address;
+	}
+
+	// Messages are small and go out once per tick, so they should not wait to be batched.
+	bool DisableSendDelay(NativeSocket socket)
+	{
+		const int isDisabled = 1;
+		return setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&isDisabled), sizeof(isDisabled)) == 0;
+	}
+}
+
+ReplicationConnection::~ReplicationConnection()
+{
+	Close();
+}
+
+bool ReplicationConnection::Accept(u16 port)
+{
+	Close();
+
+	if (!InitializeSockets())
+		return false;
+
+	const NativeSocket listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (std::uintptr_t(listener) == cInvalidSocket)
+		return false;
+
+#ifndef _WIN32
+	// Lets a run started right after the last one listen on the port again.
+	const int isReused = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &isReused, sizeof(isReused));
+#endif
+
+	const sockaddr_in address = GetLoopbackAddress(port);
+	if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 && listen(listener, 1) == 0)
+		mSocket = std::uintptr_t(accept(listener, nullptr, nullptr));
+
+	CloseSocket(listener);
+
+	if (mSocket == cInvalidSocket || !DisableSendDelay(NativeSocket(mSocket)))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool ReplicationConnection::Connect(u16 port)
+{
+	Close();
+
+	if (!InitializeSockets())
+		return false;
+
+	mSocket = std::uintptr_t(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+	if (mSocket == cInvalidSocket)
+		return false;
+
+	const sockaddr_in address = GetLoopbackAddress(port);
+	if (connect(NativeSocket(mSocket), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || !DisableSendDelay(NativeSocket(mSocket)))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool ReplicationConnection::Send(const mage::Array<u8>& message)
+{
+	const u32 size = message.GetSize();
+	if (mSocket == cInvalidSocket || size > cMaxMessageSize)
+		return false;
+
+	mSendBuffer.ResizeUninitialized(sizeof(size) + size);
+	std::memcpy(mSendBuffer.GetData(), &size, sizeof(size));
+	std::memcpy(mSendBuffer.GetData() + sizeof(size), message.GetData(), size);
+
+	if (SendAll(mSendBuffer.GetData(), mSendBuffer.GetSize()))
+		return true;
+
+	mHasFailed = true;
+	return false;
+}
+
+bool ReplicationConnection::Receive(mage::Array<u8>& message)
+{
+	if (mSocket == cInvalidSocket)
+		return false;
+
+	u32 size = 0;
+	const u32 sizeReceived = ReceiveAll(reinterpret_cast<u8*>(&size), sizeof(size));
+
+	// Closing between messages is how the stream ends. Anywhere else, it was cut short.
+	if (sizeReceived != sizeof(size))
+	{
+		mHasFailed |= sizeReceived != 0;
+		return false;
+	}
+
+	if (size > cMaxMessageSize)
+	{
+		mHasFailed = true;
+		return false;
+	}
+
+	message.ResizeUninitialized(size);
+
+	if (ReceiveAll(message.GetData(), size) != size)
+	{
+		mHasFailed = true;
+		return false;
+	}
+
+	return true;
+}
+
+void ReplicationConnection::Close()
+{
+	if (mSocket != cInvalidSocket)
+		CloseSocket(NativeSocket(mSocket));
+
+	mSocket = cInvalidSocket;
+}
+
+bool ReplicationConnection::SendAll(const u8* data, u32 size)
+{
+	for (u32 sent = 0; sent < size;)
+	{
+		const auto result = send(NativeSocket(mSocket), reinterpret_cast<const char*>(data + sent), IoSize(std::min(size - sent, cMaxTransferSize)), cSendFlags);
+		if (result <= 0)
+			return false;
+
+		sent += u32(result);
+	}
+
+	return true;
+}
+
+u32 ReplicationConnection::ReceiveAll(u8* data, u32 size)
+{
+	u32 received = 0;
+
+	while (received < size)
+	{
+		const auto result = recv(NativeSocket(mSocket), reinterpret_cast<char*>(data + received), IoSize(std::min(size - received, cMaxTransferSize)), 0);
+		if (result <= 0)
+		{
+			// Zero is the other side closing, anything less an error.
+			mHasFailed |= result < 0;
+			break;
+		}
+
+		received += u32(result);
+	}
+
+	return received;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+// Carries ReplicationEncoder's messages between processes over a TCP connection on the loopback
+// interface, each as its u32 size followed by its bytes. TCP keeps them reliable and in order, as the
+// decoder needs. Sending and receiving block until done.
+class ReplicationConnection : public NonCopyableClass
+{
+public:
+	// Larger sizes are taken to mean a damaged stream.
+	static constexpr u32 cMaxMessageSize = 64 * 1024 * 1024;
+
+	ReplicationConnection() = default;
+	~ReplicationConnection();
+
+	// Waits for a viewer to connect to the port. Only one is taken.
+	bool Accept(u16 port);
+
+	bool Connect(u16 port);
+
+	bool Send(const mage::Array<u8>& message);
+
+	// False once the other side has closed the connection, or when the stream is damaged.
+	bool Receive(mage::Array<u8>& message);
+
+	// Whether a send or receive failed for any reason other than the other side closing between messages.
+	bool HasFailed() const { return mHasFailed; }
+
+	void Close();
+
+private:
+	bool SendAll(const u8* data, u32 size);
+
+	// Bytes received before the connection closed or failed, if it did.
+	u32 ReceiveAll(u8* data, u32 size);
+
+	// INVALID_SOCKET for Winsock and -1 for POSIX sockets alike.
+	static constexpr std::uintptr_t cInvalidSocket = ~std::uintptr_t(0);
+
+	std::uintptr_t mSocket = cInvalidSocket;
+
+	// The size and the message go out in one piece, so they are not sent as separate packets.
+	mage::Array<u8> mSendBuffer;
+
+	bool mHasFailed = false;
+};
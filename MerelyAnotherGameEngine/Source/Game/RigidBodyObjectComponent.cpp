@@ -1,7 +1,22 @@
-#include "Game/RigidBodyObjectComponent.h"
 #include "Game/GameWorld.h"
+#include "Game/RigidBodyObjectComponent.h"
+#include "Game/WorldSnapshot.h"
 #include "Physics/PhysicsSystem.h"
 
+static const bool sIsSnapshotRegistered = WorldSnapshot::RegisterComponentClass<RigidBodyObjectComponent>();
+
+static physx::PxTransform GetPhysicsPose(const mage::Transform& transform)
+{
+	physx::PxTransform pose;
+	pose.p = reinterpret_cast<const physx::PxVec3&>(transform.Position);
+	pose.q.w = transform.Rotation.S;
+	pose.q.x = -transform.Rotation.YZ;
+	pose.q.y = -transform.Rotation.ZX;
+	pose.q.z = -transform.Rotation.XY;
+
+	return pose;
+}
+
 RigidBodyObjectComponent::RigidBodyObjectComponent(TransformableObject& owner, const ComponentTemplate<RigidBodyObjectComponent>& creationTemplate) :
 	GameObjectComponent(owner),
 	mRigidBodyParams(creationTemplate.RigidBodyParams),
@@ -12,14 +27,7 @@ RigidBodyObjectComponent::RigidBodyObjectComponent(TransformableObject& owner, c
 
 void RigidBodyObjectComponent::OnOwnerAddedToWorld(GameWorld& world)
 {
-	physx::PxTransform pose;
-	pose.p = reinterpret_cast<const physx::PxVec3&>(mOwner.Transform.Position);
-	pose.q.w = mOwner.Transform.Rotation.S;
-	pose.q.x = -mOwner.Transform.Rotation.YZ;
-	pose.q.y = -mOwner.Transform.Rotation.ZX;
-	pose.q.z = -mOwner.Transform.Rotation.XY;
-
-	mPhysicsActor = world.GetPhysicsSystem().AddRigidBody(mRigidBodyParams, pose, mLinearVelocity, mAngularVelocity);
+	mPhysicsActor = world.GetPhysicsSystem().AddRigidBody(mRigidBodyParams, GetPhysicsPose(mOwner.Transform), mLinearVelocity, mAngularVelocity, this);
 }
 
 void RigidBodyObjectComponent::OnOwnerRemovedFromWorld(GameWorld& world)
@@ -29,24 +37,20 @@ void RigidBodyObjectComponent::OnOwnerRemovedFromWorld(GameWorld& world)
 
 void RigidBodyObjectComponent::UpdatePrePhysics(f32 deltaTime)
 {
-	if (mRigidBodyParams.Type == PhysicsSystemObjectType::RigidKinematic)
+	// Until the actor is inserted into the scene, it still sits at its initial pose.
+	if (mRigidBodyParams.Type == PhysicsSystemObjectType::RigidKinematic && mPhysicsActor->getScene())
 	{
-		physx::PxTransform pose;
-		pose.p = reinterpret_cast<const physx::PxVec3&>(mOwner.Transform.Position);
-		pose.q.w = mOwner.Transform.Rotation.S;
-		pose.q.x = -mOwner.Transform.Rotation.YZ;
-		pose.q.y = -mOwner.Transform.Rotation.ZX;
-		pose.q.z = -mOwner.Transform.Rotation.XY;
-
-		reinterpret_cast<physx::PxRigidDynamic*>(mPhysicsActor)->setKinematicTarget(pose);
+		reinterpret_cast<physx::PxRigidDynamic*>(mPhysicsActor)->setKinematicTarget(GetPhysicsPose(mOwner.Transform));
 	}
 }
 
-void RigidBodyObjectComponent::UpdatePostPhysics(f32 deltaTime)
+void RigidBodyObjectComponent::OnPhysicsActorMoved(physx::PxRigidDynamic& actor)
 {
 	if (mRigidBodyParams.Type == PhysicsSystemObjectType::RigidDynamic)
 	{
-		const physx::PxTransform pose = mPhysicsActor->getGlobalPose();
+		mOwner.PreviousTransform = mOwner.Transform;
+
+		const physx::PxTransform pose = actor.getGlobalPose();
 		mOwner.Transform.Position = reinterpret_cast<const glm::vec3&>(pose.p);
 		mOwner.Transform.Rotation.S = pose.q.w;
 		mOwner.Transform.Rotation.XY = -pose.q.z;
@@ -54,9 +58,91 @@ void RigidBodyObjectComponent::UpdatePostPhysics(f32 deltaTime)
 		mOwner.Transform.Rotation.ZX = -pose.q.y;
 	}
 
-	if (mRigidBodyParams.Type != PhysicsSystemObjectType::RigidStatic)
+	mLinearVelocity = actor.getLinearVelocity();
+	mAngularVelocity = actor.getAngularVelocity();
+}
+
+void RigidBodyObjectComponent::OnPhysicsActorStopped(physx::PxRigidDynamic& actor)
+{
+	// Nothing to interpolate between until the actor moves again. Kinematic owners are moved, and
+	// keep their previous transform, in their own pre-physics updates.
+	if (mRigidBodyParams.Type == PhysicsSystemObjectType::RigidDynamic)
+		mOwner.PreviousTransform.reset();
+
+	mLinearVelocity = actor.getLinearVelocity();
+	mAngularVelocity = actor.getAngularVelocity();
+}
+
+// Every listener in the scene is a rigid body component, so the other side's object is its owner.
+static GameObject* GetListenerOwner(PhysicsActorListener* listener)
+{
+	return listener ? &static_cast<RigidBodyObjectComponent*>(listener)->GetOwner() : nullptr;
+}
+
+void RigidBodyObjectComponent::OnPhysicsContact(const PhysicsContactEvent& event)
+{
+	const ContactEvent ownerEvent
+	{
+		.Type = event.Type == PhysicsContactEventType::Begin ? ContactEventType::Begin : ContactEventType::End,
+		.Other = GetListenerOwner(event.Other),
+		.Position = reinterpret_cast<const glm::vec3&>(event.Position),
+		.Normal = reinterpret_cast<const glm::vec3&>(event.Normal)
+	};
+
+	mOwner.OnContact(ownerEvent);
+}
+
+void RigidBodyObjectComponent::OnPhysicsTrigger(const PhysicsTriggerEvent& event)
+{
+	const TriggerEvent ownerEvent
+	{
+		.Type = event.Type == PhysicsTriggerEventType::Enter ? TriggerEventType::Enter : TriggerEventType::Leave,
+		.Other = GetListenerOwner(event.Other),
+		.IsOwnTrigger = event.IsOwnTrigger
+	};
+
+	mOwner.OnTrigger(ownerEvent);
+}
+
+void RigidBodyObjectComponent::SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const
+{
+	data.RigidBody = writer.AddRigidBodyParams(mRigidBodyParams);
+	data.LinearVelocity = reinterpret_cast<const glm::vec3&>(mLinearVelocity);
+	data.AngularVelocity = reinterpret_cast<const glm::vec3&>(mAngularVelocity);
+}
+
+void RigidBodyObjectComponent::LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader)
+{
+	ComponentTemplate<RigidBodyObjectComponent> creationTemplate;
+	creationTemplate.RigidBodyParams = reader.GetRigidBodyParams(data.RigidBody);
+	creationTemplate.InitialLinearVelocity = reinterpret_cast<const physx::PxVec3&>(data.LinearVelocity);
+	creationTemplate.InitialAngularVelocity = reinterpret_cast<const physx::PxVec3&>(data.AngularVelocity);
+	GameObject::CreateComponent(owner, creationTemplate);
+}
+
+void RigidBodyObjectComponent::SaveRollbackState(RollbackState& state) const
+{
+	state.LinearVelocity = reinterpret_cast<const glm::vec3&>(mLinearVelocity);
+	state.AngularVelocity = reinterpret_cast<const glm::vec3&>(mAngularVelocity);
+}
+
+void RigidBodyObjectComponent::RestoreRollbackState(const RollbackState& state)
+{
+	mLinearVelocity = reinterpret_cast<const physx::PxVec3&>(state.LinearVelocity);
+	mAngularVelocity = reinterpret_cast<const physx::PxVec3&>(state.AngularVelocity);
+
+	if (mRigidBodyParams.Type == PhysicsSystemObjectType::RigidStatic)
+		return;
+
+	// Kinematic actors are teleported too; their next target then moves them on from there.
+	physx::PxRigidDynamic* actor = static_cast<physx::PxRigidDynamic*>(mPhysicsActor);
+	actor->setGlobalPose(GetPhysicsPose(mOwner.Transform));
+
+	if (mRigidBodyParams.Type == PhysicsSystemObjectType::RigidDynamic)
 	{
-		mLinearVelocity = reinterpret_cast<physx::PxRigidDynamic*>(mPhysicsActor)->getLinearVelocity();
-		mAngularVelocity = reinterpret_cast<physx::PxRigidDynamic*>(mPhysicsActor)->getAngularVelocity();
+		// Waking only works on actors which are already in the scene.
+		const bool canWake = actor->getScene() != nullptr;
+		actor->setLinearVelocity(mLinearVelocity, canWake);
+		actor->setAngularVelocity(mAngularVelocity, canWake);
 	}
 }
@@ -21,11 +21,43 @@ struct ComponentTemplate<class RigidBodyObjectComponent>
 	physx::PxVec3 InitialAngularVelocity = physx::PxVec3(physx::PxZero);
 };
 
-class RigidBodyObjectComponent : public GameObjectComponent<TransformableObject>
+class RigidBodyObjectComponent : public GameObjectComponent<TransformableObject>, public PhysicsActorListener
 {
+	friend GameObject;
+
 public:
+	static constexpr ComponentUpdateGroup cUpdateGroup = ComponentUpdateGroup::PhysicsSync;
+
 	RigidBodyObjectComponent(TransformableObject& owner, const ComponentTemplate<RigidBodyObjectComponent>& creationTemplate);
 
+	static constexpr cstr cSnapshotName = "RigidBody";
+
+	struct SnapshotData
+	{
+		u32 RigidBody;
+		glm::vec3 LinearVelocity;
+		glm::vec3 AngularVelocity;
+	};
+
+	void SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const;
+	static void LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader);
+
+	struct RollbackState
+	{
+		glm::vec3 LinearVelocity;
+		glm::vec3 AngularVelocity;
+	};
+
+	// Restoring moves the actor to where the owner's transform has been put back to.
+	void SaveRollbackState(RollbackState& state) const;
+	void RestoreRollbackState(const RollbackState& state);
+
+	TransformableObject& GetOwner() const { return mOwner; }
+
+	// As of the last physics step.
+	glm::vec3 GetLinearVelocity() const { return reinterpret_cast<const glm::vec3&>(mLinearVelocity); }
+	glm::vec3 GetAngularVelocity() const { return reinterpret_cast<const glm::vec3&>(mAngularVelocity); }
+
 protected:
 	virtual void OnOwnerAddedToWorld(GameWorld& world) override final;
 
@@ -33,7 +65,13 @@ protected:
 
 	virtual void UpdatePrePhysics(f32 deltaTime) override final;
 
-	virtual void UpdatePostPhysics(f32 deltaTime) override final;
+	virtual void OnPhysicsActorMoved(physx::PxRigidDynamic& actor) override final;
+
+	virtual void OnPhysicsActorStopped(physx::PxRigidDynamic& actor) override final;
+
+	virtual void OnPhysicsContact(const PhysicsContactEvent& event) override final;
+
+	virtual void OnPhysicsTrigger(const PhysicsTriggerEvent& event) override final;
 
 private:
 	PhysicsRigidBodyParams mRigidBodyParams;
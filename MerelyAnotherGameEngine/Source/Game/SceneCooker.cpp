@@ -0,0 +1,554 @@
+#include "Game/CameraComponent.h"
+#include "Game/RigidBodyObjectComponent.h"
+#include "Game/SceneCooker.h"
+#include "Game/SpriteObjectComponent.h"
+#include "Game/StaticMeshObjectComponent.h"
+#include "Game/TextObjectComponent.h"
+#include "Game/WorldSnapshot.h"
+#include "Utility/BallSpawnerComponent.h"
+#include "Utility/BoundedLineMovementComponent.h"
+#include "Utility/DefaultMovementComponent.h"
+#include "Utility/KillZObjectComponent.h"
+
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// One statement, with a cursor over its arguments.
+	class SceneLine
+	{
+	public:
+		SceneLine(const std::string& text, u32 number) : mNumber(number)
+		{
+			std::istringstream stream(text);
+			std::string token;
+
+			while (stream >> std::ws && !stream.eof())
+			{
+				if (stream.peek() == '#')
+					break;
+
+				if (stream.peek() == '"')
+				{
+					stream.get();
+					std::getline(stream, token, '"');
+				}
+				else
+				{
+					stream >> token;
+				}
+
+				mTokens.push_back(token);
+			}
+		}
+
+		bool IsEmpty() const { return mTokens.empty(); }
+		bool IsAtEnd() const { return mNext == mTokens.size(); }
+		u32 GetNumber() const { return mNumber; }
+		const std::string& GetKeyword() const { return mTokens[0]; }
+
+		bool ReadName(std::string& value)
+		{
+			if (IsAtEnd())
+				return false;
+
+			value = mTokens[mNext++];
+			return true;
+		}
+
+		bool ReadFloat(f32& value)
+		{
+			if (IsAtEnd())
+				return false;
+
+			const std::string& token = mTokens[mNext];
+			char* end = nullptr;
+			value = std::strtof(token.c_str(), &end);
+
+			if (end != token.c_str() + token.size())
+				return false;
+
+			++mNext;
+			return true;
+		}
+
+		bool ReadVec2(glm::vec2& value) { return ReadFloat(value.x) && ReadFloat(value.y); }
+		bool ReadVec3(glm::vec3& value) { return ReadFloat(value.x) && ReadFloat(value.y) && ReadFloat(value.z); }
+		bool ReadVec4(glm::vec4& value) { return ReadFloat(value.x) && ReadFloat(value.y) && ReadFloat(value.z) && ReadFloat(value.w); }
+
+		// A letter or digit stands for its GLFW key, anything else has to be the key code itself.
+		bool ReadKey(i32& value)
+		{
+			if (IsAtEnd())
+				return false;
+
+			const std::string& token = mTokens[mNext];
+			if (token.size() == 1 && std::isalnum(u8(token[0])))
+			{
+				value = std::toupper(u8(token[0]));
+				++mNext;
+				return true;
+			}
+
+			f32 code = 0.0f;
+			if (!ReadFloat(code))
+				return false;
+
+			value = i32(code);
+			return true;
+		}
+
+		bool IsNext(cstr word)
+		{
+			if (IsAtEnd() || mTokens[mNext] != word)
+				return false;
+
+			++mNext;
+			return true;
+		}
+
+	private:
+		std::vector<std::string> mTokens;
+		u32 mNext = 1;
+		u32 mNumber;
+	};
+
+	class SceneParser
+	{
+	public:
+		explicit SceneParser(bool useConvexHulls) : mUseConvexHulls(useConvexHulls) {}
+
+		bool Parse(mage::StringView source, std::string& error)
+		{
+			std::istringstream stream(source.GetCString());
+			std::string text;
+			u32 number = 0;
+
+			while (std::getline(stream, text))
+			{
+				SceneLine line(text, ++number);
+				if (line.IsEmpty())
+					continue;
+
+				if (!ParseLine(line, error))
+				{
+					if (error.empty())
+						error = "unexpected or missing arguments";
+
+					error = "line " + std::to_string(line.GetNumber()) + ": " + error;
+					return false;
+				}
+			}
+
+			if (mIsInObject)
+			{
+				error = "object without end";
+				return false;
+			}
+
+			return true;
+		}
+
+		mage::Array<u8> Finish() { return mBuilder.Finish(); }
+
+	private:
+		using NameMap = std::unordered_map<std::string, u32>;
+
+		bool ParseLine(SceneLine& line, std::string& error)
+		{
+			const std::string& keyword = line.GetKeyword();
+
+			if (!mIsInObject)
+			{
+				if (keyword == "mesh") return ParseAsset(line, mMeshes);
+				if (keyword == "texture") return ParseAsset(line, mTextures);
+				if (keyword == "font") return ParseAsset(line, mFonts);
+				if (keyword == "material") return ParseMaterial(line);
+				if (keyword == "body") return ParseBody(line, error);
+
+				if (keyword == "object" && line.IsAtEnd())
+				{
+					mIsInObject = true;
+					mTransform = {};
+					mBuilder.BeginObject();
+					return true;
+				}
+			}
+			else
+			{
+				if (keyword == "end" && line.IsAtEnd())
+				{
+					mIsInObject = false;
+					mBuilder.SetObjectTransform(mTransform);
+					return true;
+				}
+
+				if (keyword == "position") return line.ReadVec3(mTransform.Position) && line.IsAtEnd();
+				if (keyword == "rotation") return ParseRotation(line);
+				if (keyword == "rigidbody") return ParseRigidBody(line, error);
+				if (keyword == "staticmesh") return ParseStaticMesh(line, error);
+				if (keyword == "sprite") return ParseSprite(line, error);
+				if (keyword == "text") return ParseText(line, error);
+				if (keyword == "camera") return ParseCamera(line);
+				if (keyword == "ballspawner") return ParseBallSpawner(line, error);
+				if (keyword == "killz") return ParseKillZ(line);
+				if (keyword == "movement") return ParseMovement(line);
+				if (keyword == "boundedline") return ParseBoundedLine(line);
+			}
+
+			error = "unexpected '" + keyword + "'";
+			return false;
+		}
+
+		bool ParseAsset(SceneLine& line, NameMap& assets)
+		{
+			std::string name;
+			std::string assetName;
+
+			if (!line.ReadName(name) || !line.ReadName(assetName) || !line.IsAtEnd())
+				return false;
+
+			assets[name] = mBuilder.GetWriter().AddString(assetName.c_str());
+			return true;
+		}
+
+		bool ParseMaterial(SceneLine& line)
+		{
+			std::string name;
+			PhysicsSystemMaterialProperties material;
+
+			if (!line.ReadName(name) || !line.ReadFloat(material.StaticFriction) || !line.ReadFloat(material.DynamicFriction) ||
+				!line.ReadFloat(material.Restitution) || !line.IsAtEnd())
+				return false;
+
+			mMaterials[name] = material;
+			return true;
+		}
+
+		bool ParseBody(SceneLine& line, std::string& error)
+		{
+			static const std::unordered_map<std::string, PhysicsSystemObjectType> cTypes
+			{
+				{ "static", PhysicsSystemObjectType::RigidStatic },
+				{ "kinematic", PhysicsSystemObjectType::RigidKinematic },
+				{ "dynamic", PhysicsSystemObjectType::RigidDynamic }
+			};
+
+			static const std::unordered_map<std::string, PhysicsCollisionLayer> cLayers
+			{
+				{ "Default", PhysicsCollisionLayer::Default },
+				{ "Level", PhysicsCollisionLayer::Level },
+				{ "Paddle", PhysicsCollisionLayer::Paddle },
+				{ "Ball", PhysicsCollisionLayer::Ball },
+				{ "Trigger", PhysicsCollisionLayer::Trigger }
+			};
+
+			std::string name, type, layer, material, geometry;
+			if (!line.ReadName(name) || !line.ReadName(type) || !line.ReadName(layer) || !line.ReadName(material) || !line.ReadName(geometry))
+				return false;
+
+			WorldSnapshotRigidBody record{};
+
+			if (!cTypes.contains(type) || !cLayers.contains(layer) || !mMaterials.contains(material))
+			{
+				error = "unknown body type, layer or material";
+				return false;
+			}
+
+			record.Type = cTypes.at(type);
+			record.Layer = cLayers.at(layer);
+			record.Material = mMaterials.at(material);
+
+			bool hasSize = false;
+			if (geometry == "sphere")
+			{
+				record.GeometryType = WorldSnapshotGeometryType::Sphere;
+				hasSize = line.ReadFloat(record.GeometrySize.x);
+			}
+			else if (geometry == "box")
+			{
+				record.GeometryType = WorldSnapshotGeometryType::Box;
+				hasSize = line.ReadVec3(record.GeometrySize);
+			}
+			else if (geometry == "capsule" || geometry == "cylinder" || geometry == "cone")
+			{
+				record.GeometryType =
+					geometry == "capsule" ? WorldSnapshotGeometryType::Capsule :
+					geometry == "cylinder" ? WorldSnapshotGeometryType::Cylinder : WorldSnapshotGeometryType::Cone;
+				hasSize = line.ReadFloat(record.GeometrySize.x) && line.ReadFloat(record.GeometrySize.y);
+			}
+
+			if (!hasSize)
+			{
+				error = "unknown geometry or missing size";
+				return false;
+			}
+
+			while (!line.IsAtEnd())
+			{
+				if (line.IsNext("convex-hull")) record.Flags |= WorldSnapshotRigidBody::cUseConvexHull;
+				else if (line.IsNext("contacts")) record.Flags |= WorldSnapshotRigidBody::cReportContacts;
+				else if (line.IsNext("trigger")) record.Flags |= WorldSnapshotRigidBody::cIsTrigger;
+				else return false;
+			}
+
+			if (mUseConvexHulls && (record.GeometryType == WorldSnapshotGeometryType::Cylinder || record.GeometryType == WorldSnapshotGeometryType::Cone))
+				record.Flags |= WorldSnapshotRigidBody::cUseConvexHull;
+
+			mBodies[name] = mBuilder.GetWriter().AddRigidBody(record);
+			return true;
+		}
+
+		bool ParseRotation(SceneLine& line)
+		{
+			glm::vec3 axis;
+			f32 degrees = 0.0f;
+
+			if (!line.ReadVec3(axis) || !line.ReadFloat(degrees) || !line.IsAtEnd() || axis == glm::vec3(0.0f))
+				return false;
+
+			mTransform.Rotation = mage::Rotor(axis, glm::radians(degrees));
+			return true;
+		}
+
+		bool ParseRigidBody(SceneLine& line, std::string& error)
+		{
+			RigidBodyObjectComponent::SnapshotData data{};
+
+			if (!ReadReference(line, mBodies, data.RigidBody, error))
+				return false;
+
+			while (!line.IsAtEnd())
+			{
+				if (line.IsNext("velocity") && line.ReadVec3(data.LinearVelocity)) continue;
+				if (line.IsNext("spin") && line.ReadVec3(data.AngularVelocity)) continue;
+				return false;
+			}
+
+			mBuilder.AddComponent<RigidBodyObjectComponent>() = data;
+			return true;
+		}
+
+		bool ParseStaticMesh(SceneLine& line, std::string& error)
+		{
+			StaticMeshObjectComponent::SnapshotData data{};
+
+			if (!ReadReference(line, mMeshes, data.Mesh, error) || !ReadReference(line, mTextures, data.Texture, error) || !line.IsAtEnd())
+				return false;
+
+			mBuilder.AddComponent<StaticMeshObjectComponent>() = data;
+			return true;
+		}
+
+		bool ParseSprite(SceneLine& line, std::string& error)
+		{
+			SpriteObjectComponent::SnapshotData data{};
+
+			if (!line.ReadVec2(data.ScreenCoordsMin) || !line.ReadVec2(data.ScreenCoordsMax) ||
+				!line.ReadVec2(data.TextureCoordsMin) || !line.ReadVec2(data.TextureCoordsMax) ||
+				!ReadReference(line, mTextures, data.Texture, error) || !line.IsAtEnd())
+				return false;
+
+			mBuilder.AddComponent<SpriteObjectComponent>() = data;
+			return true;
+		}
+
+		bool ParseText(SceneLine& line, std::string& error)
+		{
+			TextObjectComponent::SnapshotData data{};
+			std::string text;
+
+			if (!line.ReadName(text) || !line.ReadVec4(data.Color) || !line.ReadVec2(data.ScreenPosition) ||
+				!line.ReadFloat(data.Scale) || !ReadReference(line, mFonts, data.Font, error) || !line.IsAtEnd())
+				return false;
+
+			data.Text = mBuilder.GetWriter().AddString(text.c_str());
+
+			mBuilder.AddComponent<TextObjectComponent>() = data;
+			return true;
+		}
+
+		bool ParseCamera(SceneLine& line)
+		{
+			if (!line.IsAtEnd())
+				return false;
+
+			mBuilder.AddComponent<CameraComponent>();
+			return true;
+		}
+
+		bool ParseBallSpawner(SceneLine& line, std::string& error)
+		{
+			BallSpawnerComponent::SnapshotData data{};
+
+			if (!ReadReference(line, mBodies, data.RigidBody, error) || !ReadReference(line, mMeshes, data.Mesh, error) ||
+				!ReadReference(line, mTextures, data.Texture, error) || !line.ReadFloat(data.Speed) || !line.ReadKey(data.InputSpawn) ||
+				!line.IsAtEnd())
+				return false;
+
+			mBuilder.AddComponent<BallSpawnerComponent>() = data;
+			return true;
+		}
+
+		bool ParseKillZ(SceneLine& line)
+		{
+			if (!line.IsAtEnd())
+				return false;
+
+			mBuilder.AddComponent<KillZObjectComponent>();
+			return true;
+		}
+
+		// The speed, optionally followed by the right, left, forward, back, up and down keys.
+		bool ParseMovement(SceneLine& line)
+		{
+			const ComponentTemplate<DefaultMovementComponent> defaults;
+
+			DefaultMovementComponent::SnapshotData data{};
+			data.InputR = defaults.InputR;
+			data.InputL = defaults.InputL;
+			data.InputF = defaults.InputF;
+			data.InputB = defaults.InputB;
+			data.InputU = defaults.InputU;
+			data.InputD = defaults.InputD;
+
+			if (!line.ReadFloat(data.Speed))
+				return false;
+
+			if (!line.IsAtEnd() && !(line.ReadKey(data.InputR) && line.ReadKey(data.InputL) && line.ReadKey(data.InputF) &&
+				line.ReadKey(data.InputB) && line.ReadKey(data.InputU) && line.ReadKey(data.InputD)))
+				return false;
+
+			if (!line.IsAtEnd())
+				return false;
+
+			mBuilder.AddComponent<DefaultMovementComponent>() = data;
+			return true;
+		}
+
+		// The extent is given in the object's own space, so it has to come after the rotation.
+		bool ParseBoundedLine(SceneLine& line)
+		{
+			BoundedLineMovementComponent::SnapshotData data{};
+			glm::vec3 extent;
+
+			if (!line.ReadVec3(extent) || !line.ReadKey(data.InputNeg) || !line.ReadKey(data.InputPos) ||
+				!line.ReadFloat(data.Acceleration) || !line.ReadFloat(data.Deceleration) || !line.ReadFloat(data.MaxSpeed) ||
+				!line.IsAtEnd())
+				return false;
+
+			// The center is the position the object starts at, like when it first joins a world.
+			data.Extent = mTransform.Rotation.Rotate(extent);
+			data.Center = mTransform.Position;
+
+			mBuilder.AddComponent<BoundedLineMovementComponent>() = data;
+			return true;
+		}
+
+		bool ReadReference(SceneLine& line, const NameMap& names, u32& value, std::string& error)
+		{
+			std::string name;
+			if (!line.ReadName(name))
+				return false;
+
+			const auto found = names.find(name);
+			if (found == names.end())
+			{
+				error = "unknown name '" + name + "'";
+				return false;
+			}
+
+			value = found->second;
+			return true;
+		}
+
+		WorldSnapshotBuilder mBuilder;
+
+		NameMap mMeshes;
+		NameMap mTextures;
+		NameMap mFonts;
+		NameMap mBodies;
+		std::unordered_map<std::string, PhysicsSystemMaterialProperties> mMaterials;
+
+		const bool mUseConvexHulls;
+
+		bool mIsInObject = false;
+		mage::Transform mTransform;
+	};
+
+	// Snapshots from before a format change would not load, so they count as stale.
+	bool IsCurrentSnapshot(mage::StringView path)
+	{
+		WorldSnapshotHeader header{};
+
+		std::ifstream file(path.GetCString(), std::ios::binary);
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+		return file.good() && header.Magic == WorldSnapshot::cMagic && header.Version == WorldSnapshot::cVersion;
+	}
+}
+
+mage::Array<u8> SceneCooker::Cook(mage::StringView source, std::string& error, bool useConvexHulls)
+{
+	SceneParser parser(useConvexHulls);
+	if (!parser.Parse(source, error))
+		return {};
+
+	return parser.Finish();
+}
+
+bool SceneCooker::CookFile(mage::StringView sourcePath, mage::StringView cookedPath, std::string& error, bool useConvexHulls)
+{
+	std::ifstream sourceFile(sourcePath.GetCString());
+	if (!sourceFile.is_open())
+	{
+		error = std::string("cannot open ") + sourcePath.GetCString();
+		return false;
+	}
+
+	std::stringstream source;
+	source << sourceFile.rdbuf();
+
+	const mage::Array<u8> cooked = Cook(source.str().c_str(), error, useConvexHulls);
+	if (cooked.IsEmpty())
+		return false;
+
+	std::error_code fileError;
+	std::filesystem::create_directories(std::filesystem::path(cookedPath.GetCString()).parent_path(), fileError);
+
+	std::ofstream cookedFile(cookedPath.GetCString(), std::ios::binary | std::ios::trunc);
+	cookedFile.write(reinterpret_cast<const char*>(cooked.GetData()), cooked.GetSize());
+
+	if (!cookedFile.good())
+	{
+		error = std::string("cannot write ") + cookedPath.GetCString();
+		return false;
+	}
+
+	return true;
+}
+
+bool SceneCooker::CookFileIfStale(mage::StringView sourcePath, mage::StringView cookedPath, std::string& error, bool useConvexHulls)
+{
+	std::error_code sourceError;
+	const auto sourceTime = std::filesystem::last_write_time(sourcePath.GetCString(), sourceError);
+	if (sourceError)
+	{
+		error = std::string("cannot open ") + sourcePath.GetCString();
+		return false;
+	}
+
+	std::error_code cookedError;
+	const auto cookedTime = std::filesystem::last_write_time(cookedPath.GetCString(), cookedError);
+
+	if (!cookedError && cookedTime >= sourceTime && IsCurrentSnapshot(cookedPath))
+		return true;
+
+	return CookFile(sourcePath, cookedPath, error, useConvexHulls);
+}
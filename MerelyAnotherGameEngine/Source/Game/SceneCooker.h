@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+
+// Scene files describe a level's objects through their components' template values, one statement
+// per line; see Scenes/Arena.scene for the syntax. Cooking turns a scene into a world snapshot, so
+// loading a level is reading one file and adding its objects, with no parsing at load time.
+class SceneCooker
+{
+public:
+	// Empty on failure, with the offending line in error. With useConvexHulls, every cylinder and cone
+	// body collides with its convex hull, as the built-in arena's do under -convex-hulls.
+	static mage::Array<u8> Cook(mage::StringView source, std::string& error, bool useConvexHulls = false);
+
+	static bool CookFile(mage::StringView sourcePath, mage::StringView cookedPath, std::string& error, bool useConvexHulls = false);
+
+	// Cooks again only when the cooked file is missing, older than the scene or from another snapshot
+	// version. Fails when the scene is missing. A cooked file only matches one useConvexHulls setting.
+	static bool CookFileIfStale(mage::StringView sourcePath, mage::StringView cookedPath, std::string& error, bool useConvexHulls = false);
+};
@@ -1,4 +1,7 @@
 #include "Game/SpriteObjectComponent.h"
+#include "Game/WorldSnapshot.h"
+
+static const bool sIsSnapshotRegistered = WorldSnapshot::RegisterComponentClass<SpriteObjectComponent>();
 
 SpriteObjectComponent::SpriteObjectComponent(GameObject& owner, const ComponentTemplate<SpriteObjectComponent>& creationTemplate) :
 	GameObjectComponent(owner),
@@ -9,3 +12,23 @@ SpriteObjectComponent::SpriteObjectComponent(GameObject& owner, const ComponentT
 	mTexture(creationTemplate.Texture)
 {
 }
+
+void SpriteObjectComponent::SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const
+{
+	data.ScreenCoordsMin = mScreenCoordsMin;
+	data.ScreenCoordsMax = mScreenCoordsMax;
+	data.TextureCoordsMin = mTextureCoordsMin;
+	data.TextureCoordsMax = mTextureCoordsMax;
+	data.Texture = writer.AddAsset(mTexture);
+}
+
+void SpriteObjectComponent::LoadSnapshot(GameObject& owner, const SnapshotData& data, WorldSnapshotReader& reader)
+{
+	ComponentTemplate<SpriteObjectComponent> creationTemplate;
+	creationTemplate.ScreenCoordsMin = data.ScreenCoordsMin;
+	creationTemplate.ScreenCoordsMax = data.ScreenCoordsMax;
+	creationTemplate.TextureCoordsMin = data.TextureCoordsMin;
+	creationTemplate.TextureCoordsMax = data.TextureCoordsMax;
+	creationTemplate.Texture = reader.GetAsset<Texture>(data.Texture);
+	GameObject::CreateComponent(owner, creationTemplate);
+}
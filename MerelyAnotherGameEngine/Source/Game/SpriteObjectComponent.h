@@ -19,6 +19,20 @@ class SpriteObjectComponent : public GameObjectComponent<GameObject>
 public:
 	SpriteObjectComponent(GameObject& owner, const ComponentTemplate<SpriteObjectComponent>& creationTemplate);
 
+	static constexpr cstr cSnapshotName = "Sprite";
+
+	struct SnapshotData
+	{
+		glm::vec2 ScreenCoordsMin;
+		glm::vec2 ScreenCoordsMax;
+		glm::vec2 TextureCoordsMin;
+		glm::vec2 TextureCoordsMax;
+		u32 Texture;
+	};
+
+	void SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const;
+	static void LoadSnapshot(GameObject& owner, const SnapshotData& data, WorldSnapshotReader& reader);
+
 	glm::vec2 GetScreenCoordsMin() const { return mScreenCoordsMin; }
 	glm::vec2 GetScreenCoordsMax() const { return mScreenCoordsMax; }
 	glm::vec2 GetTextureCoordsMin() const { return mTextureCoordsMin; }
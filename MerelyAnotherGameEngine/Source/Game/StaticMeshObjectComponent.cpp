@@ -1,6 +1,23 @@
 #include "Game/StaticMeshObjectComponent.h"
+#include "Game/WorldSnapshot.h"
+
+static const bool sIsSnapshotRegistered = WorldSnapshot::RegisterComponentClass<StaticMeshObjectComponent>();
 
 StaticMeshObjectComponent::StaticMeshObjectComponent(TransformableObject& owner, const ComponentTemplate<StaticMeshObjectComponent>& creationTemplate) :
 	GameObjectComponent(owner), mMesh(creationTemplate.Mesh), mTexture(creationTemplate.Texture)
 {
 }
+
+void StaticMeshObjectComponent::SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const
+{
+	data.Mesh = writer.AddAsset(mMesh);
+	data.Texture = writer.AddAsset(mTexture);
+}
+
+void StaticMeshObjectComponent::LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader)
+{
+	ComponentTemplate<StaticMeshObjectComponent> creationTemplate;
+	creationTemplate.Mesh = reader.GetAsset<StaticMesh>(data.Mesh);
+	creationTemplate.Texture = reader.GetAsset<Texture>(data.Texture);
+	GameObject::CreateComponent(owner, creationTemplate);
+}
@@ -17,7 +17,19 @@ class StaticMeshObjectComponent : public GameObjectComponent<TransformableObject
 public:
 	StaticMeshObjectComponent(TransformableObject& owner, const ComponentTemplate<StaticMeshObjectComponent>& creationTemplate);
 
+	static constexpr cstr cSnapshotName = "StaticMesh";
+
+	struct SnapshotData
+	{
+		u32 Mesh;
+		u32 Texture;
+	};
+
+	void SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const;
+	static void LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader);
+
 	mage::Transform const& GetTransform() const { return mOwner.Transform; }
+	mage::Transform GetInterpolatedTransform(f32 alpha) const { return mOwner.GetInterpolatedTransform(alpha); }
 	AssetHandle<StaticMesh> GetMesh() const { return mMesh; }
 	AssetHandle<Texture> GetTexture() const { return mTexture; }
 
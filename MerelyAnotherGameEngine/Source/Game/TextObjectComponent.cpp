@@ -1,4 +1,7 @@
 #include "Game/TextObjectComponent.h"
+#include "Game/WorldSnapshot.h"
+
+static const bool sIsSnapshotRegistered = WorldSnapshot::RegisterComponentClass<TextObjectComponent>();
 
 TextObjectComponent::TextObjectComponent(GameObject& owner, const ComponentTemplate<TextObjectComponent>& creationTemplate) :
 	GameObjectComponent(owner),
@@ -9,3 +12,23 @@ TextObjectComponent::TextObjectComponent(GameObject& owner, const ComponentTempl
 	mFont(creationTemplate.Font)
 {
 }
+
+void TextObjectComponent::SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const
+{
+	data.Text = writer.AddString(mText);
+	data.Color = mColor;
+	data.ScreenPosition = mScreenPosition;
+	data.Scale = mScale;
+	data.Font = writer.AddAsset(mFont);
+}
+
+void TextObjectComponent::LoadSnapshot(GameObject& owner, const SnapshotData& data, WorldSnapshotReader& reader)
+{
+	ComponentTemplate<TextObjectComponent> creationTemplate;
+	creationTemplate.Text = reader.GetString(data.Text);
+	creationTemplate.Color = data.Color;
+	creationTemplate.ScreenPosition = data.ScreenPosition;
+	creationTemplate.Scale = data.Scale;
+	creationTemplate.Font = reader.GetAsset<Font>(data.Font);
+	GameObject::CreateComponent(owner, creationTemplate);
+}
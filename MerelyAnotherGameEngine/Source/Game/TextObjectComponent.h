@@ -19,6 +19,20 @@ class TextObjectComponent : public GameObjectComponent<GameObject>
 public:
 	TextObjectComponent(GameObject& owner, const ComponentTemplate<TextObjectComponent>& creationTemplate);
 
+	static constexpr cstr cSnapshotName = "Text";
+
+	struct SnapshotData
+	{
+		u32 Text;
+		glm::vec4 Color;
+		glm::vec2 ScreenPosition;
+		f32 Scale;
+		u32 Font;
+	};
+
+	void SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const;
+	static void LoadSnapshot(GameObject& owner, const SnapshotData& data, WorldSnapshotReader& reader);
+
 	mage::StringView GetText() const { return mText; }
 	glm::vec4 GetColor() const { return mColor; }
 	glm::vec2 GetScreenPosition() const { return mScreenPosition; }
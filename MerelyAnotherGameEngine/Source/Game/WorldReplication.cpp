@@ -0,0 +1,418 @@
+#include "Game/GameWorld.h"
+#include "Game/RigidBodyObjectComponent.h"
+#include "Game/WorldReplication.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace
+{
+	constexpr u32 cHeaderSize = 3 * sizeof(u32);
+	constexpr u32 cWidthBits = 5;
+
+	// Keeps every difference, and so every zig-zag value, below 2^31, within what a 5-bit width covers.
+	constexpr i32 cMaxQuantized = (1 << 29) - 1;
+
+	// Gap, mask, and every field at the widest.
+	constexpr u32 cMaxObjectBits = cWidthBits + 31 + QuantizedReplicatedObject::cFieldCount * (1 + cWidthBits + 4 * 31);
+
+	// Rounds half away from zero without going through the library's rounding functions.
+	i32 Quantize(f32 value, f32 scale, i32 limit)
+	{
+		const f32 scaled = std::clamp(value * scale, -f32(limit), f32(limit));
+		return i32(scaled + (scaled < 0.0f ? -0.5f : 0.5f));
+	}
+
+	u32 ZigZag(i32 value) { return (u32(value) << 1) ^ u32(value >> 31); }
+	i32 UnZigZag(u32 value) { return i32(value >> 1) ^ -i32(value & 1); }
+
+	// The caller sizes the buffer for the worst case up front.
+	class BitWriter
+	{
+	public:
+		BitWriter(u8* data) : mData(data) {}
+
+		void Write(u32 value, u32 bitCount)
+		{
+			mBits |= u64(value) << mBitCount;
+			mBitCount += bitCount;
+
+			if (mBitCount >= 32)
+			{
+				const u32 word = u32(mBits);
+				std::memcpy(mData + mSize, &word, sizeof(word));
+				mSize += sizeof(word);
+				mBits >>= 32;
+				mBitCount -= 32;
+			}
+		}
+
+		void WriteGap(u32 value)
+		{
+			const u32 width = u32(std::bit_width(value));
+			mage_check(width < 32);
+
+			Write(width, cWidthBits);
+			Write(value, width);
+		}
+
+		// Bytes used, including the last partial one.
+		u32 Finish()
+		{
+			for (; mBitCount > 0; mBitCount = mBitCount > 8 ? mBitCount - 8 : 0, mBits >>= 8)
+				mData[mSize++] = u8(mBits);
+
+			return mSize;
+		}
+
+	private:
+		u8* mData;
+		u32 mSize = 0;
+		u64 mBits = 0;
+		u32 mBitCount = 0;
+	};
+
+	// Reading past the end gives zeros and marks the reader as overrun, which is checked once at the end.
+	class BitReader
+	{
+	public:
+		BitReader(const u8* data, u32 size) : mData(data), mSize(size) {}
+
+		u32 Read(u32 bitCount)
+		{
+			if (bitCount == 0)
+				return 0;
+
+			while (mBitCount < bitCount && mOffset < mSize)
+			{
+				mBits |= u64(mData[mOffset++]) << mBitCount;
+				mBitCount += 8;
+			}
+
+			if (mBitCount < bitCount)
+			{
+				mHasOverrun = true;
+				return 0;
+			}
+
+			const u32 value = u32(mBits & ((u64(1) << bitCount) - 1));
+			mBits >>= bitCount;
+			mBitCount -= bitCount;
+
+			return value;
+		}
+
+		u32 ReadGap() { return Read(Read(cWidthBits)); }
+
+		bool HasOverrun() const { return mHasOverrun; }
+
+	private:
+		const u8* mData;
+		u32 mSize;
+		u32 mOffset = 0;
+		u64 mBits = 0;
+		u32 mBitCount = 0;
+		bool mHasOverrun = false;
+	};
+
+	void WriteChangedFields(BitWriter& writer, const QuantizedReplicatedObject& current, const QuantizedReplicatedObject& previous, u32 mask)
+	{
+		for (u32 field = 0; field < QuantizedReplicatedObject::cFieldCount; ++field)
+		{
+			if ((mask & (1 << field)) == 0)
+				continue;
+
+			const u32 begin = QuantizedReplicatedObject::cFieldOffsets[field];
+			const u32 end = QuantizedReplicatedObject::cFieldOffsets[field + 1];
+
+			u32 differences[4];
+			u32 combined = 0;
+
+			for (u32 i = begin; i < end; ++i)
+			{
+				differences[i - begin] = ZigZag(current.Values[i] - previous.Values[i]);
+				combined |= differences[i - begin];
+			}
+
+			const u32 width = u32(std::bit_width(combined));
+			writer.Write(width, cWidthBits);
+
+			for (u32 i = begin; i < end; ++i)
+				writer.Write(differences[i - begin], width);
+		}
+	}
+
+	u32 GetChangedFields(const QuantizedReplicatedObject& current, const QuantizedReplicatedObject& previous)
+	{
+		u32 mask = 0;
+
+		for (u32 field = 0; field < QuantizedReplicatedObject::cFieldCount; ++field)
+		{
+			const u32 begin = QuantizedReplicatedObject::cFieldOffsets[field];
+			const u32 end = QuantizedReplicatedObject::cFieldOffsets[field + 1];
+
+			for (u32 i = begin; i < end; ++i)
+				if (current.Values[i] != previous.Values[i])
+					mask |= 1 << field;
+		}
+
+		return mask;
+	}
+
+	void ReadChangedFields(BitReader& reader, QuantizedReplicatedObject& object, u32 mask)
+	{
+		for (u32 field = 0; field < QuantizedReplicatedObject::cFieldCount; ++field)
+		{
+			if ((mask & (1 << field)) == 0)
+				continue;
+
+			const u32 width = reader.Read(cWidthBits);
+
+			for (u32 i = QuantizedReplicatedObject::cFieldOffsets[field]; i < QuantizedReplicatedObject::cFieldOffsets[field + 1]; ++i)
+				object.Values[i] += UnZigZag(reader.Read(width));
+		}
+	}
+}
+
+const mage::Array<ReplicatedObject>& ReplicationSource::Gather()
+{
+	++mGatherCount;
+	mObjects.Empty();
+
+	mWorld.ForEach<RigidBodyObjectComponent>([this](RigidBodyObjectComponent& rigidBody)
+		{
+			const TransformableObject& owner = rigidBody.GetOwner();
+			if (owner.IsDestroyed())
+				return;
+
+			const auto [found, isNew] = mTrackedObjects.try_emplace(owner.GetSerial());
+			if (isNew)
+			{
+				if (mFreeIds.IsEmpty())
+				{
+					found->second.Id = mNextId++;
+				}
+				else
+				{
+					found->second.Id = mFreeIds.GetLast();
+					mFreeIds.RemoveAt(mFreeIds.GetSize() - 1);
+				}
+			}
+
+			found->second.LastGather = mGatherCount;
+			mObjects.Add({ found->second.Id, owner.Transform, rigidBody.GetLinearVelocity(), rigidBody.GetAngularVelocity() });
+		});
+
+	// Freed after this gather's objects took theirs, so they are only reused by the next one.
+	std::erase_if(mTrackedObjects, [this](const auto& tracked)
+		{
+			if (tracked.second.LastGather == mGatherCount)
+				return false;
+
+			mFreeIds.Add(tracked.second.Id);
+			return true;
+		});
+
+	std::sort(mObjects.begin(), mObjects.end(), [](const ReplicatedObject& a, const ReplicatedObject& b) { return a.Id < b.Id; });
+
+	return mObjects;
+}
+
+void ReplicationEncoder::Encode(const mage::Array<ReplicatedObject>& objects, mage::Array<u8>& message)
+{
+	const mage::Array<QuantizedReplicatedObject>& previous = mStates[mPreviousState];
+	mage::Array<QuantizedReplicatedObject>& current = mStates[mPreviousState ^ 1];
+
+	current.ResizeUninitialized(objects.GetSize());
+
+	for (u32 i = 0; i < objects.GetSize(); ++i)
+	{
+		const ReplicatedObject& object = objects[i];
+		mage_check(i == 0 || objects[i - 1].Id < object.Id);
+
+		QuantizedReplicatedObject& quantized = current[i];
+		quantized.Id = object.Id;
+
+		for (u32 axis = 0; axis < 3; ++axis)
+		{
+			quantized.Values[axis] = Quantize(object.Transform.Position[axis], 1.0f / cPositionStep, cMaxQuantized);
+			quantized.Values[7 + axis] = Quantize(object.LinearVelocity[axis], 1.0f / cVelocityStep, cMaxQuantized);
+			quantized.Values[10 + axis] = Quantize(object.AngularVelocity[axis], 1.0f / cVelocityStep, cMaxQuantized);
+		}
+
+		quantized.Values[3] = Quantize(object.Transform.Rotation.S, cRotorScale, i32(cRotorScale));
+		quantized.Values[4] = Quantize(object.Transform.Rotation.XY, cRotorScale, i32(cRotorScale));
+		quantized.Values[5] = Quantize(object.Transform.Rotation.YZ, cRotorScale, i32(cRotorScale));
+		quantized.Values[6] = Quantize(object.Transform.Rotation.ZX, cRotorScale, i32(cRotorScale));
+	}
+
+	message.ResizeUninitialized(cHeaderSize + ((previous.GetSize() * (cWidthBits + 31) + current.GetSize() * cMaxObjectBits) + 7) / 8);
+	BitWriter writer(message.GetData() + cHeaderSize);
+
+	u32 removedCount = 0;
+	u32 nextId = 0;
+
+	for (u32 i = 0, j = 0; i < previous.GetSize(); ++i)
+	{
+		while (j < current.GetSize() && current[j].Id < previous[i].Id)
+			++j;
+
+		if (j < current.GetSize() && current[j].Id == previous[i].Id)
+			continue;
+
+		writer.WriteGap(previous[i].Id - nextId);
+		nextId = previous[i].Id + 1;
+		++removedCount;
+	}
+
+	// New objects are written as differences from all zeros.
+	const QuantizedReplicatedObject zero{};
+
+	u32 changedCount = 0;
+	nextId = 0;
+
+	for (u32 i = 0, j = 0; j < current.GetSize(); ++j)
+	{
+		while (i < previous.GetSize() && previous[i].Id < current[j].Id)
+			++i;
+
+		const bool isNew = i == previous.GetSize() || previous[i].Id != current[j].Id;
+		const QuantizedReplicatedObject& base = isNew ? zero : previous[i];
+
+		const u32 mask = GetChangedFields(current[j], base);
+		if (mask == 0 && !isNew)
+			continue;
+
+		writer.WriteGap(current[j].Id - nextId);
+		nextId = current[j].Id + 1;
+
+		writer.Write(mask, QuantizedReplicatedObject::cFieldCount);
+		WriteChangedFields(writer, current[j], base, mask);
+		++changedCount;
+	}
+
+	const u32 header[] = { mMessageIndex++, removedCount, changedCount };
+	std::memcpy(message.GetData(), header, cHeaderSize);
+
+	message.ResizeUninitialized(cHeaderSize + writer.Finish());
+
+	mPreviousState ^= 1;
+}
+
+void ReplicationEncoder::Reset()
+{
+	mStates[mPreviousState].Empty();
+	mMessageIndex = 0;
+}
+
+bool ReplicationDecoder::Decode(const u8* message, u32 size)
+{
+	u32 header[3];
+	if (size < cHeaderSize)
+		return false;
+
+	std::memcpy(header, message, cHeaderSize);
+	const auto [messageIndex, removedCount, changedCount] = header;
+
+	if (messageIndex != 0 && messageIndex != mNextMessageIndex)
+		return false;
+
+	// A keyframe diffs against nothing. The stored state is only replaced once the message has decoded,
+	// so a damaged keyframe leaves it for the deltas which follow.
+	static const mage::Array<QuantizedReplicatedObject> sEmptyState;
+	const mage::Array<QuantizedReplicatedObject>& previous = messageIndex == 0 ? sEmptyState : mStates[mPreviousState];
+	mage::Array<QuantizedReplicatedObject>& current = mStates[mPreviousState ^ 1];
+	current.Empty();
+
+	BitReader reader(message + cHeaderSize, size - cHeaderSize);
+
+	// Every entry takes at least a bit, which bounds the counts before anything is allocated for them.
+	if (u64(removedCount) + changedCount > u64(size - cHeaderSize) * 8)
+		return false;
+
+	mRemovedIds.ResizeUninitialized(removedCount);
+	for (u32 i = 0, nextId = 0; i < removedCount; ++i)
+	{
+		mRemovedIds[i] = nextId + reader.ReadGap();
+		nextId = mRemovedIds[i] + 1;
+	}
+
+	u32 changedRead = 0;
+	u32 nextChangedId = 0;
+	u32 changedId = UINT32_MAX;
+
+	auto readChangedId = [&]()
+		{
+			changedId = changedRead < changedCount ? nextChangedId + reader.ReadGap() : UINT32_MAX;
+			nextChangedId = changedId + 1;
+		};
+
+	readChangedId();
+
+	u32 removedIndex = 0;
+
+	for (u32 i = 0; (i < previous.GetSize() || changedRead < changedCount) && !reader.HasOverrun();)
+	{
+		const bool hasPrevious = i < previous.GetSize();
+
+		if (hasPrevious && previous[i].Id < changedId)
+		{
+			if (removedIndex < removedCount && mRemovedIds[removedIndex] == previous[i].Id)
+				++removedIndex;
+			else
+				current.Add(previous[i]);
+
+			++i;
+			continue;
+		}
+
+		QuantizedReplicatedObject& object = current[current.AddUninitialized()];
+
+		if (hasPrevious && previous[i].Id == changedId)
+		{
+			object = previous[i++];
+		}
+		else
+		{
+			object = {};
+			object.Id = changedId;
+		}
+
+		ReadChangedFields(reader, object, reader.Read(QuantizedReplicatedObject::cFieldCount));
+
+		++changedRead;
+		readChangedId();
+	}
+
+	// Every removed id has to have been there.
+	if (reader.HasOverrun() || removedIndex != removedCount)
+		return false;
+
+	mPreviousState ^= 1;
+	mNextMessageIndex = messageIndex + 1;
+
+	mObjects.ResizeUninitialized(current.GetSize());
+
+	for (u32 i = 0; i < current.GetSize(); ++i)
+	{
+		const QuantizedReplicatedObject& quantized = current[i];
+		ReplicatedObject& object = mObjects[i];
+
+		object.Id = quantized.Id;
+
+		for (u32 axis = 0; axis < 3; ++axis)
+		{
+			object.Transform.Position[axis] = f32(quantized.Values[axis]) * ReplicationEncoder::cPositionStep;
+			object.LinearVelocity[axis] = f32(quantized.Values[7 + axis]) * ReplicationEncoder::cVelocityStep;
+			object.AngularVelocity[axis] = f32(quantized.Values[10 + axis]) * ReplicationEncoder::cVelocityStep;
+		}
+
+		object.Transform.Rotation.S = f32(quantized.Values[3]) / ReplicationEncoder::cRotorScale;
+		object.Transform.Rotation.XY = f32(quantized.Values[4]) / ReplicationEncoder::cRotorScale;
+		object.Transform.Rotation.YZ = f32(quantized.Values[5]) / ReplicationEncoder::cRotorScale;
+		object.Transform.Rotation.ZX = f32(quantized.Values[6]) / ReplicationEncoder::cRotorScale;
+	}
+
+	return true;
+}
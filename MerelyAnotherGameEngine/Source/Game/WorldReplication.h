@@ -0,0 +1,104 @@
+#pragma once
+
+#include <unordered_map>
+
+class GameWorld;
+
+// What viewers get to see of an object: where it is and how it moves.
+struct ReplicatedObject
+{
+	u32 Id;
+	mage::Transform Transform;
+	glm::vec3 LinearVelocity;
+	glm::vec3 AngularVelocity;
+};
+
+// The fixed point form which encoder and decoder diff: position, rotor, linear and angular velocity.
+struct QuantizedReplicatedObject
+{
+	static constexpr u32 cFieldCount = 4;
+	static constexpr u32 cFieldOffsets[cFieldCount + 1] = { 0, 3, 7, 10, 13 };
+
+	u32 Id;
+	i32 Values[13];
+};
+
+// Collects the rigid bodies of a world for replication. Ids stay the same for as long as an object is
+// in the world, and an id freed by one gather is only handed out again by the next, so a viewer never
+// mistakes a new object for the one before it. Objects are told apart by serial, as a new one may take
+// the address of one just freed.
+class ReplicationSource : public NonCopyableClass
+{
+public:
+	ReplicationSource(GameWorld& world) : mWorld(world) {}
+
+	// Sorted by id, as ReplicationEncoder takes them.
+	const mage::Array<ReplicatedObject>& Gather();
+
+private:
+	struct TrackedObject
+	{
+		u32 Id;
+		u64 LastGather;
+	};
+
+	GameWorld& mWorld;
+
+	mage::Array<ReplicatedObject> mObjects;
+	std::unordered_map<u64, TrackedObject> mTrackedObjects;
+	mage::Array<u32> mFreeIds;
+	u32 mNextId = 0;
+	u64 mGatherCount = 0;
+};
+
+// Turns consecutive states of a set of objects into messages for a reliable, ordered stream such as a
+// local socket or pipe. Positions, rotor components and velocities are quantized, and each message
+// only has the objects which changed since the previous one, with the differences of their changed
+// fields packed at the bit width the largest difference needs. Both sides diff against the quantized
+// state, so errors never add up.
+//
+// Message layout: a 12-byte header of three u32, the message index, the number of removed ids and the
+// number of changed objects, then a bit stream, filled from the lowest bit of each byte up, with the
+// removed ids followed by the changed objects. Ids are written as the gap to the previous one, as a
+// 5-bit width followed by the gap at that width. A changed object is its id gap, a 4-bit mask of
+// changed fields (position, rotation, linear and angular velocity), and per changed field a 5-bit
+// width followed by the zig-zag encoded difference of each of its components at that width.
+class ReplicationEncoder : public NonCopyableClass
+{
+public:
+	static constexpr f32 cPositionStep = 1.0f / 1024.0f;
+	static constexpr f32 cRotorScale = 32767.0f;
+	static constexpr f32 cVelocityStep = 1.0f / 256.0f;
+
+	// Objects must be sorted by id. Replaces the message's contents.
+	void Encode(const mage::Array<ReplicatedObject>& objects, mage::Array<u8>& message);
+
+	// The next message starts over from nothing, for a viewer which joins or falls out of step.
+	void Reset();
+
+private:
+	// The previous state and the one being encoded take turns, keeping their memory.
+	mage::Array<QuantizedReplicatedObject> mStates[2];
+	u32 mPreviousState = 0;
+	u32 mMessageIndex = 0;
+};
+
+// Rebuilds the objects from ReplicationEncoder's messages, which have to arrive in order. A message
+// with index 0 starts over, like the encoder does after Reset.
+class ReplicationDecoder : public NonCopyableClass
+{
+public:
+	// False for damaged or out of order messages, which leave the objects as they were.
+	bool Decode(const u8* message, u32 size);
+
+	// Sorted by id.
+	const mage::Array<ReplicatedObject>& GetObjects() const { return mObjects; }
+
+private:
+	mage::Array<QuantizedReplicatedObject> mStates[2];
+	u32 mPreviousState = 0;
+	u32 mNextMessageIndex = 0;
+
+	mage::Array<u32> mRemovedIds;
+	mage::Array<ReplicatedObject> mObjects;
+};
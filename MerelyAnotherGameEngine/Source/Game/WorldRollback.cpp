@@ -0,0 +1,160 @@
+#include "Game/GameWorld.h"
+#include "Game/InputRecording.h"
+#include "Game/InputSystem.h"
+#include "Game/WorldRollback.h"
+
+#include <cstring>
+#include <unordered_set>
+
+WorldRollback::WorldRollback(GameWorld& world, u32 frameCount) :
+	mWorld(world)
+{
+	mage_check(frameCount > 0 && mWorld.mRollback == nullptr && !mWorld.mIsAsyncPhysics);
+
+	mFrames.ResizeDefault(frameCount);
+	mWorld.mRollback = this;
+}
+
+WorldRollback::~WorldRollback()
+{
+	mWorld.mRollback = nullptr;
+}
+
+TransformableObject* WorldRollback::GetTransformable(GameObject& object)
+{
+	return object.IsTransformable() ? static_cast<TransformableObject*>(&object) : nullptr;
+}
+
+u8* WorldRollback::AddState(mage::Array<u8>& state, u32 size)
+{
+	const u32 offset = state.GetSize();
+	state.ResizeUninitialized(offset + (size + cStateAlignment - 1) / cStateAlignment * cStateAlignment);
+
+	return state.GetData() + offset;
+}
+
+void WorldRollback::Capture()
+{
+	// Async physics is rejected while attached, so the last step's results are all in already.
+	++mLatestFrame;
+	Frame& frame = mFrames[u32(mLatestFrame % mFrames.GetSize())];
+
+	frame.AccumulatedTime = mWorld.mAccumulatedTime;
+	frame.Objects.ResizeUninitialized(u32(mWorld.mObjects.size()));
+	frame.State.Empty();
+
+	for (u32 i = 0; i < frame.Objects.GetSize(); ++i)
+	{
+		GameObject* object = mWorld.mObjects[i].get();
+		frame.Objects[i] = object;
+
+		if (TransformableObject* transformable = GetTransformable(*object))
+			std::memcpy(AddState(frame.State, sizeof(mage::Transform)), &transformable->Transform, sizeof(mage::Transform));
+
+		for (const GameObject::ComponentInstance& instance : object->mComponents)
+			if (ComponentRollbackInfo const* rollback = instance.ClassInfo->Rollback)
+				rollback->Save(*instance.Component, AddState(frame.State, rollback->StateSize));
+	}
+
+	const mage::Array<i32>& keyStates = mWorld.GetInputSystem().mKeyStates;
+	frame.KeyStates.ResizeUninitialized(keyStates.GetSize());
+	std::memcpy(frame.KeyStates.GetData(), keyStates.GetData(), keyStates.GetSize() * sizeof(i32));
+
+	// Objects which no kept frame has any more can go.
+	const u64 oldestFrame = GetOldestFrame();
+	std::erase_if(mRemovedObjects, [oldestFrame](const auto& removed) { return removed.second.LastFrame < oldestFrame; });
+}
+
+void WorldRollback::OnObjectRemoved(const std::shared_ptr<GameObject>& object)
+{
+	// Objects removed by a restore are not in any kept frame.
+	if (mIsRestoring || mLatestFrame == 0)
+		return;
+
+	mRemovedObjects[object.get()] = { object, mLatestFrame };
+}
+
+bool WorldRollback::Restore(u64 frameNumber)
+{
+	if (!HasFrame(frameNumber))
+		return false;
+
+	mWorld.SyncPhysics();
+
+	const Frame& frame = mFrames[u32(frameNumber % mFrames.GetSize())];
+	const std::unordered_set<GameObject*> frameObjects(frame.Objects.begin(), frame.Objects.end());
+
+	mIsRestoring = true;
+
+	for (const std::shared_ptr<GameObject>& object : mWorld.mObjects)
+		if (!frameObjects.contains(object.get()))
+			object->Destroy();
+
+	mWorld.RemoveDestroyedObjects();
+
+	for (GameObject* object : frame.Objects)
+	{
+		if (object->mWorld == &mWorld)
+			continue;
+
+		const auto removed = mRemovedObjects.find(object);
+		mage_check(removed != mRemovedObjects.end());
+
+		object->mIsDestoryed = false;
+		mWorld.AddObject(removed->second.Object);
+	}
+
+	mIsRestoring = false;
+
+	// Whatever left after the frame was either just added back or never part of it.
+	std::erase_if(mRemovedObjects, [frameNumber](const auto& removed) { return removed.second.LastFrame >= frameNumber; });
+
+	const u8* state = frame.State.GetData();
+	auto takeState = [&state](u32 size)
+		{
+			const u8* current = state;
+			state += (size + cStateAlignment - 1) / cStateAlignment * cStateAlignment;
+			return current;
+		};
+
+	for (GameObject* object : frame.Objects)
+	{
+		// Transforms go first, as restoring rigid bodies moves their actors to them.
+		if (TransformableObject* transformable = GetTransformable(*object))
+		{
+			std::memcpy(&transformable->Transform, takeState(sizeof(mage::Transform)), sizeof(mage::Transform));
+			transformable->PreviousTransform.reset();
+		}
+
+		for (const GameObject::ComponentInstance& instance : object->mComponents)
+			if (ComponentRollbackInfo const* rollback = instance.ClassInfo->Rollback)
+				rollback->Restore(*instance.Component, takeState(rollback->StateSize));
+	}
+
+	mage_check(state == frame.State.GetData() + frame.State.GetSize());
+
+	mage::Array<i32>& keyStates = mWorld.GetInputSystem().mKeyStates;
+	keyStates.ResizeUninitialized(frame.KeyStates.GetSize());
+	std::memcpy(keyStates.GetData(), frame.KeyStates.GetData(), frame.KeyStates.GetSize() * sizeof(i32));
+
+	mWorld.mAccumulatedTime = frame.AccumulatedTime;
+	mWorld.mInterpolationAlpha = mWorld.mFixedStepTime > 0.0f ? frame.AccumulatedTime / mWorld.mFixedStepTime : 1.0f;
+
+	mLatestFrame = frameNumber;
+
+	return true;
+}
+
+bool WorldRollback::Resimulate(u64 frameNumber, const InputFrame* inputs, u32 inputCount)
+{
+	if (!Restore(frameNumber))
+		return false;
+
+	for (u32 i = 0; i < inputCount; ++i)
+	{
+		inputs[i].Apply(mWorld.GetInputSystem());
+		mWorld.Update(inputs[i].DeltaTime);
+	}
+
+	return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Game/GameObject.h"
+
+#include <memory>
+#include <unordered_map>
+
+class GameWorld;
+struct InputFrame;
+
+// Keeps the world's state at the end of each of its last updates in a fixed ring of frames, so the world
+// can be rewound a few frames and resimulated with corrected input, as networked modes do when remote
+// input arrives late. A frame holds which objects were in the world, their transforms, the state of
+// components which declare a RollbackState (rigid body velocities among them) and the pressed keys.
+// Capturing copies these into the buffers of the frame being overwritten, so once the ring has warmed up
+// it is a copy per object and component, without the lookups and allocations of a snapshot.
+//
+// PhysX keeps contact and solver caches of its own which are not rolled back, so resimulating with the
+// same input comes close to the original run but is not bit-identical.
+class WorldRollback : public NonCopyableClass
+{
+	friend GameWorld;
+
+public:
+	// Attaches to the world, which captures a frame at the end of every Update from then on. A frame needs
+	// the results of the update's last step, so the world cannot use async physics while attached.
+	WorldRollback(GameWorld& world, u32 frameCount);
+	~WorldRollback();
+
+	// Frames are numbered by the updates since attaching, from 1. Zero before the first update.
+	u64 GetLatestFrame() const { return mLatestFrame; }
+	u64 GetOldestFrame() const { return mLatestFrame >= mFrames.GetSize() ? mLatestFrame - mFrames.GetSize() + 1 : 1; }
+	bool HasFrame(u64 frame) const { return frame != 0 && frame >= GetOldestFrame() && frame <= mLatestFrame; }
+
+	// Puts the world back to the end of the given frame and drops the frames after it. Objects added since
+	// are removed and objects removed since are added back.
+	bool Restore(u64 frame);
+
+	// Restores the frame, then updates the world once per input frame, capturing each update again.
+	bool Resimulate(u64 frame, const InputFrame* inputs, u32 inputCount);
+
+private:
+	// Every state in a frame starts 8-byte aligned, like snapshot data.
+	static constexpr u32 cStateAlignment = 8;
+
+	struct Frame
+	{
+		f32 AccumulatedTime;
+		mage::Array<GameObject*> Objects;
+		mage::Array<u8> State;
+		mage::Array<i32> KeyStates;
+	};
+
+	struct RemovedObject
+	{
+		std::shared_ptr<GameObject> Object;
+
+		// The latest frame which still has the object.
+		u64 LastFrame;
+	};
+
+	void Capture();
+	void OnObjectRemoved(const std::shared_ptr<GameObject>& object);
+
+	static TransformableObject* GetTransformable(GameObject& object);
+	static u8* AddState(mage::Array<u8>& state, u32 size);
+
+	GameWorld& mWorld;
+
+	mage::Array<Frame> mFrames;
+	u64 mLatestFrame = 0;
+
+	// Objects which left the world while frames still refer to them, kept alive to be added back.
+	std::unordered_map<GameObject*, RemovedObject> mRemovedObjects;
+
+	bool mIsRestoring = false;
+};
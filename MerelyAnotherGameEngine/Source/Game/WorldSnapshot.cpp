@@ -0,0 +1,490 @@
+#include "Game/GameWorld.h"
+#include "Game/WorldSnapshot.h"
+#include "Physics/PhysicsSystem.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+	constexpr u32 cSectionAlignment = 16;
+
+	u64 HashName(cstr name)
+	{
+		return mage::HashBytes(name, std::strlen(name));
+	}
+
+	template<typename Type>
+	u32 AddSection(mage::Array<u8>& data, const Type* elements, u32 count)
+	{
+		const u32 offset = (data.GetSize() + cSectionAlignment - 1) & ~(cSectionAlignment - 1);
+		data.ResizeDefault(offset + count * u32(sizeof(Type)));
+
+		if (count > 0)
+			std::memcpy(data.GetData() + offset, elements, count * sizeof(Type));
+
+		return offset;
+	}
+
+	bool IsSectionValid(u32 offset, u64 count, u64 elementSize, u32 size)
+	{
+		return offset % cSectionAlignment == 0 && offset + count * elementSize <= size;
+	}
+
+	template<typename Type>
+	const Type* GetSection(const WorldSnapshotHeader& header, u32 offset)
+	{
+		return reinterpret_cast<const Type*>(reinterpret_cast<const u8*>(&header) + offset);
+	}
+
+	std::map<u64, ComponentSnapshotInfo const*>& GetComponentClasses()
+	{
+		static std::map<u64, ComponentSnapshotInfo const*> sComponentClasses;
+		return sComponentClasses;
+	}
+}
+
+u32 WorldSnapshotWriter::AddString(mage::StringView text)
+{
+	const auto [found, isNew] = mStringOffsets.try_emplace(text.GetCString(), mStrings.GetSize());
+	if (!isNew)
+		return found->second;
+
+	const u32 offset = found->second;
+
+	mStrings.ResizeUninitialized(offset + text.GetLength() + 1);
+	std::memcpy(mStrings.GetData() + offset, text.GetCString(), text.GetLength());
+	mStrings[offset + text.GetLength()] = '\0';
+
+	return offset;
+}
+
+u32 WorldSnapshotWriter::AddRigidBodyParams(const PhysicsRigidBodyParams& params)
+{
+	const u8 flags =
+		(params.ReportContacts ? WorldSnapshotRigidBody::cReportContacts : 0) |
+		(params.IsTrigger ? WorldSnapshotRigidBody::cIsTrigger : 0) |
+		(params.UseConvexHull ? WorldSnapshotRigidBody::cUseConvexHull : 0);
+
+	const RigidBodyKey key(params.Geometry.get(), params.Material.get(), u32(params.Type) | u32(params.Layer) << 8 | u32(flags) << 16);
+
+	if (auto found = mRigidBodyIndices.find(key); found != mRigidBodyIndices.end())
+		return found->second;
+
+	WorldSnapshotRigidBody record{};
+	record.Type = params.Type;
+	record.Layer = params.Layer;
+	record.Flags = flags;
+
+	if (!params.Geometry || !params.Material)
+	{
+		mHasFailed = true;
+		return 0;
+	}
+
+	switch (params.Geometry->getType())
+	{
+		case physx::PxGeometryType::eSPHERE:
+			record.GeometryType = WorldSnapshotGeometryType::Sphere;
+			record.GeometrySize.x = static_cast<const physx::PxSphereGeometry&>(*params.Geometry).radius;
+			break;
+
+		case physx::PxGeometryType::eBOX:
+			record.GeometryType = WorldSnapshotGeometryType::Box;
+			record.GeometrySize = reinterpret_cast<const glm::vec3&>(static_cast<const physx::PxBoxGeometry&>(*params.Geometry).halfExtents);
+			break;
+
+		case physx::PxGeometryType::eCAPSULE:
+			record.GeometryType = WorldSnapshotGeometryType::Capsule;
+			record.GeometrySize.x = static_cast<const physx::PxCapsuleGeometry&>(*params.Geometry).radius;
+			record.GeometrySize.y = static_cast<const physx::PxCapsuleGeometry&>(*params.Geometry).halfHeight;
+			break;
+
+		case physx::PxGeometryType::eCUSTOM:
+			if (auto* cylinder = dynamic_cast<physx::PxCustomGeometryExt::CylinderCallbacks*>(params.CustomGeometryCallbacks.get()))
+			{
+				record.GeometryType = WorldSnapshotGeometryType::Cylinder;
+				record.GeometrySize = glm::vec3(cylinder->getHeight(), cylinder->getRadius(), f32(cylinder->getAxis()));
+				break;
+			}
+
+			if (auto* cone = dynamic_cast<physx::PxCustomGeometryExt::ConeCallbacks*>(params.CustomGeometryCallbacks.get()))
+			{
+				record.GeometryType = WorldSnapshotGeometryType::Cone;
+				record.GeometrySize = glm::vec3(cone->getHeight(), cone->getRadius(), f32(cone->getAxis()));
+				break;
+			}
+
+			[[fallthrough]];
+
+		default:
+			mHasFailed = true;
+			return 0;
+	}
+
+	record.Material = params.Material->GetProperties();
+
+	const u32 index = mRigidBodies.Add(record);
+	mRigidBodyIndices.emplace(key, index);
+
+	return index;
+}
+
+WorldSnapshotReader::WorldSnapshotReader(GameWorld& world, const WorldSnapshotHeader& header, const char* strings, AssetManager const* assetManager) :
+	mWorld(world),
+	mHeader(header),
+	mStrings(strings),
+	mAssetManager(assetManager),
+	mRigidBodyParams(header.RigidBodyCount)
+{
+}
+
+mage::StringView WorldSnapshotReader::GetString(u32 offset)
+{
+	if (offset >= mHeader.StringsSize)
+	{
+		mHasFailed = true;
+		return {};
+	}
+
+	return mStrings + offset;
+}
+
+const PhysicsRigidBodyParams& WorldSnapshotReader::GetRigidBodyParams(u32 index)
+{
+	if (index >= mHeader.RigidBodyCount)
+	{
+		static const PhysicsRigidBodyParams sMissingParams;
+
+		mHasFailed = true;
+		return sMissingParams;
+	}
+
+	std::optional<PhysicsRigidBodyParams>& params = mRigidBodyParams[index];
+	if (params)
+		return *params;
+
+	const WorldSnapshotRigidBody& record = GetSection<WorldSnapshotRigidBody>(mHeader, mHeader.RigidBodiesOffset)[index];
+	const glm::vec3 size = record.GeometrySize;
+
+	params.emplace();
+	params->Type = record.Type;
+	params->Layer = record.Layer;
+	params->ReportContacts = record.Flags & WorldSnapshotRigidBody::cReportContacts;
+	params->IsTrigger = record.Flags & WorldSnapshotRigidBody::cIsTrigger;
+	params->UseConvexHull = record.Flags & WorldSnapshotRigidBody::cUseConvexHull;
+	params->Material = mWorld.GetPhysicsSystem().CreateMaterial(record.Material);
+
+	switch (record.GeometryType)
+	{
+		case WorldSnapshotGeometryType::Sphere:
+			params->Geometry = std::make_shared<physx::PxSphereGeometry>(size.x);
+			break;
+
+		case WorldSnapshotGeometryType::Box:
+			params->Geometry = std::make_shared<physx::PxBoxGeometry>(size.x, size.y, size.z);
+			break;
+
+		case WorldSnapshotGeometryType::Capsule:
+			params->Geometry = std::make_shared<physx::PxCapsuleGeometry>(size.x, size.y);
+			break;
+
+		case WorldSnapshotGeometryType::Cylinder:
+			params->CustomGeometryCallbacks = std::make_shared<physx::PxCustomGeometryExt::CylinderCallbacks>(size.x, size.y, i32(size.z));
+			params->Geometry = std::make_shared<physx::PxCustomGeometry>(*params->CustomGeometryCallbacks);
+			break;
+
+		case WorldSnapshotGeometryType::Cone:
+			params->CustomGeometryCallbacks = std::make_shared<physx::PxCustomGeometryExt::ConeCallbacks>(size.x, size.y, i32(size.z));
+			params->Geometry = std::make_shared<physx::PxCustomGeometry>(*params->CustomGeometryCallbacks);
+			break;
+	}
+
+	return *params;
+}
+
+void WorldSnapshotBuilder::BeginObject()
+{
+	mObjects.Add({ .FirstComponent = mComponents.GetSize() });
+}
+
+void* WorldSnapshotBuilder::AddComponent(const ComponentSnapshotInfo& snapshotInfo)
+{
+	const auto [found, isNewClass] = mClassIndices.try_emplace(&snapshotInfo, mClasses.GetSize());
+	if (isNewClass)
+	{
+		mClasses.Add({ .NameHash = HashName(snapshotInfo.Name), .DataSize = snapshotInfo.DataSize });
+		mClassData.AddDefault();
+	}
+
+	// Zeroed first, so that padding in the data is the same in every snapshot.
+	mage::Array<u8>& data = mClassData[found->second];
+	const u32 dataIndex = data.GetSize() / snapshotInfo.DataSize;
+	data.ResizeDefault(data.GetSize() + snapshotInfo.DataSize);
+
+	mComponents.Add({ found->second, dataIndex });
+
+	WorldSnapshotObject& object = mObjects.GetLast();
+	object.ComponentCount++;
+	object.IsTransformable |= snapshotInfo.NeedsTransformableOwner;
+
+	return data.GetData() + dataIndex * snapshotInfo.DataSize;
+}
+
+mage::Array<u8> WorldSnapshotBuilder::Finish()
+{
+	if (mWriter.mHasFailed)
+		return {};
+
+	mage::Array<u8> result;
+	result.ResizeDefault(sizeof(WorldSnapshotHeader));
+
+	WorldSnapshotHeader header{};
+	header.Magic = WorldSnapshot::cMagic;
+	header.Version = WorldSnapshot::cVersion;
+
+	header.ObjectCount = mObjects.GetSize();
+	header.ObjectsOffset = AddSection(result, mObjects.GetData(), mObjects.GetSize());
+
+	header.ComponentCount = mComponents.GetSize();
+	header.ComponentsOffset = AddSection(result, mComponents.GetData(), mComponents.GetSize());
+
+	for (u32 i = 0; i < mClasses.GetSize(); ++i)
+	{
+		mClasses[i].DataCount = mClassData[i].GetSize() / mClasses[i].DataSize;
+		mClasses[i].DataOffset = AddSection(result, mClassData[i].GetData(), mClassData[i].GetSize());
+	}
+
+	header.ClassCount = mClasses.GetSize();
+	header.ClassesOffset = AddSection(result, mClasses.GetData(), mClasses.GetSize());
+
+	header.RigidBodyCount = mWriter.mRigidBodies.GetSize();
+	header.RigidBodiesOffset = AddSection(result, mWriter.mRigidBodies.GetData(), mWriter.mRigidBodies.GetSize());
+
+	header.StringsSize = mWriter.mStrings.GetSize();
+	header.StringsOffset = AddSection(result, mWriter.mStrings.GetData(), mWriter.mStrings.GetSize());
+
+	header.Size = result.GetSize();
+	std::memcpy(result.GetData(), &header, sizeof(header));
+
+	return result;
+}
+
+mage::Array<u8> WorldSnapshot::Save(GameWorld& world)
+{
+	world.SyncPhysics();
+
+	WorldSnapshotBuilder builder;
+
+	for (const std::shared_ptr<GameObject>& object : world.mObjects)
+	{
+		if (object->IsDestroyed())
+			continue;
+
+		builder.BeginObject();
+
+		for (const GameObject::ComponentInstance& instance : object->mComponents)
+			if (ComponentSnapshotInfo const* snapshotInfo = instance.ClassInfo->Snapshot)
+				snapshotInfo->Save(*instance.Component, builder.AddComponent(*snapshotInfo), builder.GetWriter());
+
+		if (builder.IsObjectTransformable())
+			builder.SetObjectTransform(static_cast<const TransformableObject&>(*object).Transform);
+	}
+
+	return builder.Finish();
+}
+
+bool WorldSnapshot::Load(GameWorld& world, const u8* data, u32 size, AssetManager const* assetManager)
+{
+	if (!Validate(data, size))
+		return false;
+
+	const WorldSnapshotHeader& header = *reinterpret_cast<const WorldSnapshotHeader*>(data);
+	const WorldSnapshotObject* objects = GetSection<WorldSnapshotObject>(header, header.ObjectsOffset);
+	const WorldSnapshotComponent* components = GetSection<WorldSnapshotComponent>(header, header.ComponentsOffset);
+	const WorldSnapshotClass* classes = GetSection<WorldSnapshotClass>(header, header.ClassesOffset);
+
+	// Resolve every class before adding anything, so that a snapshot is loaded entirely or not at all.
+	mage::Array<ComponentSnapshotInfo const*> snapshotInfos;
+	snapshotInfos.Reserve(header.ClassCount);
+
+	for (u32 i = 0; i < header.ClassCount; ++i)
+	{
+		ComponentSnapshotInfo const* snapshotInfo = FindComponentClass(classes[i].NameHash);
+		if (snapshotInfo == nullptr || snapshotInfo->DataSize != classes[i].DataSize)
+			return false;
+
+		snapshotInfos.Add(snapshotInfo);
+	}
+
+	for (u32 i = 0; i < header.ObjectCount; ++i)
+		for (u32 j = 0; j < objects[i].ComponentCount; ++j)
+			if (snapshotInfos[components[objects[i].FirstComponent + j].ClassIndex]->NeedsTransformableOwner && !objects[i].IsTransformable)
+				return false;
+
+	// Restoring relies on objects joining the world right away.
+	mage_check(!world.mIsCurrentlyUpdatingObjects);
+	world.SyncPhysics();
+
+	// Components keep views of their text, so the strings move to storage the world owns.
+	std::unique_ptr<char[]> strings;
+	if (header.StringsSize > 0)
+	{
+		strings = std::make_unique<char[]>(header.StringsSize);
+		std::memcpy(strings.get(), data + header.StringsOffset, header.StringsSize);
+	}
+
+	WorldSnapshotReader reader(world, header, strings.get(), assetManager);
+
+	// Objects come out of one block per object type, which they all share ownership of, and each
+	// class's pool grows once for all of its components.
+	u32 transformableCount = 0;
+	for (u32 i = 0; i < header.ObjectCount; ++i)
+		transformableCount += objects[i].IsTransformable ? 1 : 0;
+
+	const std::shared_ptr<TransformableObject[]> transformables(new TransformableObject[transformableCount]);
+	const std::shared_ptr<GameObject[]> plainObjects(new GameObject[header.ObjectCount - transformableCount]);
+
+	for (u32 i = 0; i < header.ClassCount; ++i)
+		snapshotInfos[i]->Reserve(classes[i].DataCount);
+
+	std::vector<std::shared_ptr<GameObject>> loadedObjects;
+	loadedObjects.reserve(header.ObjectCount);
+
+	u32 nextTransformable = 0;
+	u32 nextPlainObject = 0;
+
+	for (u32 i = 0; i < header.ObjectCount; ++i)
+	{
+		const WorldSnapshotObject& record = objects[i];
+
+		std::shared_ptr<GameObject> object;
+		if (record.IsTransformable)
+		{
+			TransformableObject& transformable = transformables[nextTransformable++];
+			transformable.Transform = record.Transform;
+			object = std::shared_ptr<GameObject>(transformables, &transformable);
+		}
+		else
+		{
+			object = std::shared_ptr<GameObject>(plainObjects, &plainObjects[nextPlainObject++]);
+		}
+
+		object->mComponents.Reserve(record.ComponentCount);
+
+		for (u32 j = 0; j < record.ComponentCount; ++j)
+		{
+			const WorldSnapshotComponent& component = components[record.FirstComponent + j];
+			const WorldSnapshotClass& snapshotClass = classes[component.ClassIndex];
+
+			snapshotInfos[component.ClassIndex]->Load(*object, data + snapshotClass.DataOffset + component.DataIndex * snapshotClass.DataSize, reader);
+		}
+
+		// Components which referred to anything outside the snapshot were built from placeholders, and
+		// Restore below pairs components with their data by position. Nothing has joined the world yet,
+		// so dropping the objects built so far undoes the load.
+		if (reader.mHasFailed || !mage_ensure(object->mComponents.GetSize() == record.ComponentCount))
+			return false;
+
+		loadedObjects.push_back(std::move(object));
+	}
+
+	world.AddObjects(loadedObjects);
+
+	if (strings)
+		world.mSnapshotStrings.push_back(std::move(strings));
+
+	for (u32 i = 0; i < header.ObjectCount; ++i)
+	{
+		const WorldSnapshotObject& record = objects[i];
+		GameObject& object = *loadedObjects[i];
+
+		for (u32 j = 0; j < record.ComponentCount; ++j)
+		{
+			const WorldSnapshotComponent& component = components[record.FirstComponent + j];
+			const WorldSnapshotClass& snapshotClass = classes[component.ClassIndex];
+
+			if (auto restore = snapshotInfos[component.ClassIndex]->Restore)
+				restore(*object.mComponents[j].Component, data + snapshotClass.DataOffset + component.DataIndex * snapshotClass.DataSize);
+		}
+	}
+
+	return true;
+}
+
+bool WorldSnapshot::SaveToFile(GameWorld& world, mage::StringView path)
+{
+	const mage::Array<u8> data = Save(world);
+	if (data.IsEmpty())
+		return false;
+
+	std::ofstream file(path.GetCString(), std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(data.GetData()), data.GetSize());
+
+	return file.good();
+}
+
+bool WorldSnapshot::LoadFromFile(GameWorld& world, mage::StringView path, AssetManager const* assetManager)
+{
+	std::error_code error;
+	if (!std::filesystem::is_regular_file(path.GetCString(), error))
+		return false;
+
+	const mage::Array<u8> data = mage::ReadFile(path);
+	return Load(world, data.GetData(), data.GetSize(), assetManager);
+}
+
+void WorldSnapshot::RegisterComponentClass(const ComponentSnapshotInfo& snapshotInfo)
+{
+	const auto [found, isNew] = GetComponentClasses().try_emplace(HashName(snapshotInfo.Name), &snapshotInfo);
+	mage_check(isNew || found->second == &snapshotInfo);
+}
+
+ComponentSnapshotInfo const* WorldSnapshot::FindComponentClass(u64 nameHash)
+{
+	const auto found = GetComponentClasses().find(nameHash);
+	return found != GetComponentClasses().end() ? found->second : nullptr;
+}
+
+bool WorldSnapshot::Validate(const u8* data, u32 size)
+{
+	if (data == nullptr || reinterpret_cast<uintptr_t>(data) % 8 != 0 || size < sizeof(WorldSnapshotHeader))
+		return false;
+
+	const WorldSnapshotHeader& header = *reinterpret_cast<const WorldSnapshotHeader*>(data);
+
+	if (header.Magic != cMagic || header.Version != cVersion || header.Size != size)
+		return false;
+
+	if (!IsSectionValid(header.ObjectsOffset, header.ObjectCount, sizeof(WorldSnapshotObject), size) ||
+		!IsSectionValid(header.ComponentsOffset, header.ComponentCount, sizeof(WorldSnapshotComponent), size) ||
+		!IsSectionValid(header.ClassesOffset, header.ClassCount, sizeof(WorldSnapshotClass), size) ||
+		!IsSectionValid(header.RigidBodiesOffset, header.RigidBodyCount, sizeof(WorldSnapshotRigidBody), size) ||
+		!IsSectionValid(header.StringsOffset, header.StringsSize, 1, size))
+		return false;
+
+	const WorldSnapshotClass* classes = GetSection<WorldSnapshotClass>(header, header.ClassesOffset);
+	for (u32 i = 0; i < header.ClassCount; ++i)
+		if (classes[i].DataSize == 0 || !IsSectionValid(classes[i].DataOffset, classes[i].DataCount, classes[i].DataSize, size))
+			return false;
+
+	const WorldSnapshotObject* objects = GetSection<WorldSnapshotObject>(header, header.ObjectsOffset);
+	for (u32 i = 0; i < header.ObjectCount; ++i)
+		if (u64(objects[i].FirstComponent) + objects[i].ComponentCount > header.ComponentCount)
+			return false;
+
+	const WorldSnapshotComponent* components = GetSection<WorldSnapshotComponent>(header, header.ComponentsOffset);
+	for (u32 i = 0; i < header.ComponentCount; ++i)
+		if (components[i].ClassIndex >= header.ClassCount || components[i].DataIndex >= classes[components[i].ClassIndex].DataCount)
+			return false;
+
+	const WorldSnapshotRigidBody* rigidBodies = GetSection<WorldSnapshotRigidBody>(header, header.RigidBodiesOffset);
+	for (u32 i = 0; i < header.RigidBodyCount; ++i)
+		if (rigidBodies[i].GeometryType > WorldSnapshotGeometryType::Cone)
+			return false;
+
+	// Strings are read up to their terminator, which has to be within the section.
+	return header.StringsSize == 0 || data[header.StringsOffset + header.StringsSize - 1] == '\0';
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include "Assets/AssetManager.h"
+#include "Game/GameObject.h"
+#include "Physics/PhysicsCommon.h"
+
+#include <map>
+#include <string>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+class GameWorld;
+
+// Snapshots are one flat block without pointers, so they can be used straight from a mapped file.
+// All offsets are in bytes from the start of the block, and every section starts 16-byte aligned.
+// Component state is stored per class, as an array of that class's SnapshotData, which loading reads
+// in place. Anything shared between components (rigid body settings, text) goes into tables which
+// components refer to by index, and assets are referred to by name, which is stored with the strings.
+struct WorldSnapshotHeader
+{
+	u32 Magic;
+	u32 Version;
+	u32 Size;
+
+	u32 ObjectCount;
+	u32 ObjectsOffset;
+
+	// In object order, each object's components in the order they were created.
+	u32 ComponentCount;
+	u32 ComponentsOffset;
+
+	u32 ClassCount;
+	u32 ClassesOffset;
+
+	u32 RigidBodyCount;
+	u32 RigidBodiesOffset;
+
+	// Null-terminated strings, referred to by offset within this section.
+	u32 StringsSize;
+	u32 StringsOffset;
+};
+
+struct WorldSnapshotObject
+{
+	mage::Transform Transform;
+	u32 FirstComponent;
+	u32 ComponentCount;
+	u32 IsTransformable;
+};
+
+struct WorldSnapshotComponent
+{
+	u32 ClassIndex;
+	u32 DataIndex;
+};
+
+struct WorldSnapshotClass
+{
+	u64 NameHash;
+	u32 DataSize;
+	u32 DataCount;
+	u32 DataOffset;
+	u32 Padding;
+};
+
+enum class WorldSnapshotGeometryType : u8
+{
+	Sphere,
+	Box,
+	Capsule,
+	Cylinder,
+	Cone
+};
+
+// PhysicsRigidBodyParams without its shared pointers.
+struct WorldSnapshotRigidBody
+{
+	static constexpr u8 cReportContacts = 1 << 0;
+	static constexpr u8 cIsTrigger = 1 << 1;
+	static constexpr u8 cUseConvexHull = 1 << 2;
+
+	PhysicsSystemObjectType Type;
+	PhysicsCollisionLayer Layer;
+	WorldSnapshotGeometryType GeometryType;
+	u8 Flags;
+
+	// Sphere: radius. Box: half extents. Capsule: radius and half height. Cylinder and cone: height,
+	// radius and axis.
+	glm::vec3 GeometrySize;
+
+	PhysicsSystemMaterialProperties Material;
+};
+
+// Collects what components share while a world is saved.
+class WorldSnapshotWriter : public NonCopyableClass
+{
+	friend class WorldSnapshotBuilder;
+
+public:
+	// For references to assets which components do not have.
+	static constexpr u32 cNoAsset = ~u32(0);
+
+	// Equal strings are stored once.
+	u32 AddString(mage::StringView text);
+
+	// Bodies sharing geometry and material are stored once. Only sphere, box, capsule, cylinder and
+	// cone geometries can be saved; anything else makes the whole save fail.
+	u32 AddRigidBodyParams(const PhysicsRigidBodyParams& params);
+
+	// For bodies which only exist as a description so far.
+	u32 AddRigidBody(const WorldSnapshotRigidBody& record) { return mRigidBodies.Add(record); }
+
+	// Only named assets can be saved, see AssetManager::SetName; anything else makes the whole save fail.
+	template <AssetType Type>
+	u32 AddAsset(AssetHandle<Type> handle)
+	{
+		if (handle.GetAsset() == nullptr)
+			return cNoAsset;
+
+		if (cstr name = handle.GetAssetName())
+			return AddString(name);
+
+		mHasFailed = true;
+		return cNoAsset;
+	}
+
+private:
+	using RigidBodyKey = std::tuple<const void*, const void*, u32>;
+
+	mage::Array<char> mStrings;
+	std::map<std::string, u32, std::less<>> mStringOffsets;
+	mage::Array<WorldSnapshotRigidBody> mRigidBodies;
+	std::map<RigidBodyKey, u32> mRigidBodyIndices;
+	bool mHasFailed = false;
+};
+
+// Turns what components refer to back into live objects while a snapshot is loaded. A reference outside
+// the snapshot gives empty text, params without geometry or an empty handle, and fails the load.
+class WorldSnapshotReader : public NonCopyableClass
+{
+	friend class WorldSnapshot;
+
+public:
+	// Text lives as long as the world, as components keep views into it.
+	mage::StringView GetString(u32 offset);
+
+	// Bodies saved with the same settings share the params, and so their geometry and material.
+	const PhysicsRigidBodyParams& GetRigidBodyParams(u32 index);
+
+	// Empty handles for assets the asset manager does not have, and when loading without one.
+	template <AssetType Type>
+	AssetHandle<Type> GetAsset(u32 nameOffset)
+	{
+		if (nameOffset == WorldSnapshotWriter::cNoAsset)
+			return AssetHandle<Type>();
+
+		const mage::StringView name = GetString(nameOffset);
+		return mAssetManager != nullptr ? mAssetManager->FindHandle<Type>(name) : AssetHandle<Type>();
+	}
+
+private:
+	WorldSnapshotReader(GameWorld& world, const WorldSnapshotHeader& header, const char* strings, AssetManager const* assetManager);
+
+	GameWorld& mWorld;
+	const WorldSnapshotHeader& mHeader;
+	const char* mStrings;
+	AssetManager const* mAssetManager;
+
+	std::vector<std::optional<PhysicsRigidBodyParams>> mRigidBodyParams;
+
+	bool mHasFailed = false;
+};
+
+// Assembles a snapshot one object at a time. Components added after BeginObject belong to that object.
+class WorldSnapshotBuilder : public NonCopyableClass
+{
+public:
+	void BeginObject();
+
+	// The returned data is zeroed, and valid until the next component is added.
+	void* AddComponent(const ComponentSnapshotInfo& snapshotInfo);
+
+	template<GameObjectComponentClass ComponentClass>
+	typename ComponentClass::SnapshotData& AddComponent()
+	{
+		return *static_cast<typename ComponentClass::SnapshotData*>(AddComponent(*GameObject::GetComponentClassInfo<ComponentClass>().Snapshot));
+	}
+
+	// Only kept for objects with components which need a TransformableObject owner.
+	bool IsObjectTransformable() const { return mObjects.GetLast().IsTransformable; }
+	void SetObjectTransform(const mage::Transform& transform) { mObjects.GetLast().Transform = transform; }
+
+	WorldSnapshotWriter& GetWriter() { return mWriter; }
+
+	// Empty when the writer failed to store something.
+	mage::Array<u8> Finish();
+
+private:
+	WorldSnapshotWriter mWriter;
+
+	mage::Array<WorldSnapshotObject> mObjects;
+	mage::Array<WorldSnapshotComponent> mComponents;
+	mage::Array<WorldSnapshotClass> mClasses;
+	mage::Array<mage::Array<u8>> mClassData;
+	std::map<ComponentSnapshotInfo const*, u32> mClassIndices;
+};
+
+// Saves the objects of a world with their components' state, and adds them back to a world later.
+// Components of classes without snapshot support are left out, see GameObject::GetComponentSnapshotInfo.
+// Loading finds classes by name, so each class registers itself during static initialization.
+class WorldSnapshot
+{
+public:
+	static constexpr u32 cMagic = 0x534e414d; // "MANS"
+	static constexpr u32 cVersion = 2;
+
+	template<GameObjectComponentClass ComponentClass>
+	static bool RegisterComponentClass()
+	{
+		RegisterComponentClass(*GameObject::GetComponentClassInfo<ComponentClass>().Snapshot);
+		return true;
+	}
+
+	// Completes a running simulation first, so the world is not const. Empty on failure.
+	static mage::Array<u8> Save(GameWorld& world);
+
+	// Adds the snapshot's objects to the world. The data must be 8-byte aligned, as mage::Array and
+	// mapped files are. Nothing is added when the snapshot is damaged, from another version or has
+	// classes which are not registered. The objects are allocated together, so their memory is only
+	// freed once the last of them is.
+	static bool Load(GameWorld& world, const u8* data, u32 size, AssetManager const* assetManager);
+
+	static bool SaveToFile(GameWorld& world, mage::StringView path);
+	static bool LoadFromFile(GameWorld& world, mage::StringView path, AssetManager const* assetManager);
+
+private:
+	static void RegisterComponentClass(const ComponentSnapshotInfo& snapshotInfo);
+	static ComponentSnapshotInfo const* FindComponentClass(u64 nameHash);
+
+	static bool Validate(const u8* data, u32 size);
+};
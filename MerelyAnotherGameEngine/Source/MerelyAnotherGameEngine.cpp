@@ -2,14 +2,27 @@
 #include "Assets/FontFactory.h"
 #include "Assets/StaticMeshFactory.h"
 #include "Assets/TextureFactory.h"
+#include "Benchmarks/BenchmarkUtils.h"
+#include "Benchmarks/JobSystemBenchmark.h"
+#include "Benchmarks/PhysicsBenchmark.h"
+#include "Benchmarks/PhysicsStressBenchmark.h"
+#include "Benchmarks/ReplicationBenchmark.h"
+#include "Core/JobSystem.h"
 #include "Game/GameObject.h"
 #include "Game/GameWorld.h"
+#include "Game/GameWorldHost.h"
+#include "Game/InputRecording.h"
 #include "Game/InputSystem.h"
+#include "Game/ReplicationTransport.h"
+#include "Game/SceneCooker.h"
+#include "Game/WorldReplication.h"
+#include "Game/WorldRollback.h"
 #include "Game/CameraComponent.h"
 #include "Game/RigidBodyObjectComponent.h"
 #include "Game/SpriteObjectComponent.h"
 #include "Game/StaticMeshObjectComponent.h"
 #include "Game/TextObjectComponent.h"
+#include "Game/WorldSnapshot.h"
 #include "Physics/PhysicsSystem.h"
 #include "Rendering/Systems/MeshRenderSystem.h"
 #include "Rendering/Systems/SpriteRenderSystem.h"
@@ -17,16 +30,69 @@
 #include "Utility/BallSpawnerComponent.h"
 #include "Utility/BoundedLineMovementComponent.h"
 #include "Utility/DefaultMovementComponent.h"
+#include "Utility/KillZObjectComponent.h"
 #include "Vulkan/Renderer.h"
 #include "Vulkan/VulkanInterface.h"
 #include "Vulkan/Window.h"
 
 #include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
 #include <memory>
+#include <optional>
 
 static constexpr i32 gWindowWidth = 1920;
 static constexpr i32 gWindowHeight = 1080;
 
+static constexpr f32 gBoardSize = 20.0f;
+
+static constexpr f32 gCornerHalfHeight = 3.0f;
+static constexpr f32 gCornerRadius = 4.0f;
+static constexpr f32 gCornerPosition = gBoardSize - gCornerRadius;
+
+static constexpr f32 gCapsuleDistance = gCornerPosition + 4.0f;
+static constexpr f32 gCapsuleElevation = 2.0f;
+static constexpr f32 gCapsuleRadius = 2.0f;
+static constexpr f32 gCapsuleLength = 1.5f;
+
+static constexpr f32 gConeHeight = 8.0f;
+static constexpr f32 gConeRadius = 5.0f;
+
+static constexpr f32 gBallRadius = 1.0f;
+
+// Balls falling off the board end in a trigger slab whose top is at gKillZ.
+static constexpr f32 gKillZ = -10.0f;
+static constexpr f32 gKillZoneHalfSize = 1000.0f;
+static constexpr f32 gKillZoneHalfHeight = 5.0f;
+
+// Everything the arena draws with. Headless worlds share one set without GPU resources, which they
+// never render but snapshots and scenes refer to.
+struct ArenaAssets
+{
+	AssetManager const* Manager = nullptr;
+
+	AssetHandle<StaticMesh> BoxMesh;
+	AssetHandle<StaticMesh> CylinderMesh;
+	AssetHandle<StaticMesh> CapsuleMesh;
+	AssetHandle<StaticMesh> ConeMesh;
+	AssetHandle<StaticMesh> BallMesh;
+
+	// Loaded from -obstacle-mesh <file.obj>, empty otherwise.
+	AssetHandle<StaticMesh> ObstacleMesh;
+
+	AssetHandle<Texture> SpriteTexture;
+	AssetHandle<Texture> CubeTexture;
+	AssetHandle<Texture> BallTexture;
+	AssetHandle<Texture> CylinderTexture;
+	AssetHandle<Texture> CapsuleTexture;
+	AssetHandle<Texture> ConeTexture;
+
+	AssetHandle<Font> FontArianaVioleta;
+	AssetHandle<Font> FontOrbitron;
+};
+
 std::shared_ptr<TransformableObject> CreateControllableCamera(
 	const mage::Transform& transform,
 	f32 speed,
@@ -80,6 +146,21 @@ std::shared_ptr<TransformableObject> CreateLevelObject(
 	return objectPtr;
 }
 
+std::shared_ptr<TransformableObject> CreateKillZone(PhysicsRigidBodyParams rigidBodyParams)
+{
+	std::shared_ptr<TransformableObject> objectPtr = std::make_shared<TransformableObject>();
+	TransformableObject& object = *objectPtr.get();
+	object.Transform.Position = glm::vec3(0.0f, 0.0f, gKillZ - gKillZoneHalfHeight);
+
+	ComponentTemplate<RigidBodyObjectComponent> rigidBodyTemplate;
+	rigidBodyTemplate.RigidBodyParams = rigidBodyParams;
+	GameObject::CreateComponent(object, rigidBodyTemplate);
+
+	GameObject::CreateComponent(object, ComponentTemplate<KillZObjectComponent>());
+
+	return objectPtr;
+}
+
 std::shared_ptr<TransformableObject> CreateCapsule(
 	const mage::Transform& transform,
 	PhysicsRigidBodyParams rigidBodyParams,
@@ -157,126 +238,603 @@ std::shared_ptr<GameObject> CreateUserInterface(
 	return objectPtr;
 }
 
-i32 main()
+bool HasCommandLineSwitch(i32 argc, char** argv, cstr name)
 {
-	Vulkan::WindowInfo windowCreateInfo
+	for (i32 i = 1; i < argc; ++i)
+		if (std::strcmp(argv[i], name) == 0)
+			return true;
+
+	return false;
+}
+
+u32 GetCommandLineValue(i32 argc, char** argv, cstr name, u32 defaultValue)
+{
+	for (i32 i = 1; i + 1 < argc; ++i)
+		if (std::strcmp(argv[i], name) == 0)
+			return u32(std::max(std::atoi(argv[i + 1]), 0));
+
+	return defaultValue;
+}
+
+cstr GetCommandLineString(i32 argc, char** argv, cstr name)
+{
+	for (i32 i = 1; i + 1 < argc; ++i)
+		if (std::strcmp(argv[i], name) == 0)
+			return argv[i + 1];
+
+	return nullptr;
+}
+
+// -threads <count> sizes the job system, -pin-threads pins its workers to hardware threads.
+mage::JobSystemSettings GetJobSystemSettingsFromCommandLine(i32 argc, char** argv)
+{
+	mage::JobSystemSettings settings;
+
+	for (i32 i = 1; i < argc; ++i)
 	{
-		.Name = "Merely Another Game Engine",
-		.Width = gWindowWidth,
-		.Height = gWindowHeight
-	};
+		if (std::strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+			settings.ThreadCount = u32(std::max(std::atoi(argv[++i]), 0));
+		else if (std::strcmp(argv[i], "-pin-threads") == 0)
+			settings.PinWorkers = true;
+	}
 
-	Vulkan::Instance vulkan;
-	Vulkan::Window window = vulkan.CreateWindow(windowCreateInfo);
-	Vulkan::Renderer renderer{ vulkan, window };
+	return settings;
+}
 
-	Vulkan::ShaderCompiler shaderCompiler;
+// -solver pgs|tgs, -broadphase sap|mbp|abp|pabp and -no-pcm configure the physics scene.
+PhysicsSystemSettings GetPhysicsSystemSettingsFromCommandLine(i32 argc, char** argv)
+{
+	PhysicsSystemSettings settings;
 
-	constexpr f32 boardSize = 20.0f;
+	for (i32 i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-solver") == 0 && i + 1 < argc)
+		{
+			++i;
+			settings.Solver = std::strcmp(argv[i], "tgs") == 0 ? PhysicsSolverType::TGS : PhysicsSolverType::PGS;
+		}
+		else if (std::strcmp(argv[i], "-broadphase") == 0 && i + 1 < argc)
+		{
+			++i;
+			if (std::strcmp(argv[i], "sap") == 0)
+				settings.BroadPhase = PhysicsBroadPhaseType::SAP;
+			else if (std::strcmp(argv[i], "mbp") == 0)
+				settings.BroadPhase = PhysicsBroadPhaseType::MBP;
+			else if (std::strcmp(argv[i], "abp") == 0)
+				settings.BroadPhase = PhysicsBroadPhaseType::ABP;
+			else
+				settings.BroadPhase = PhysicsBroadPhaseType::PABP;
+		}
+		else if (std::strcmp(argv[i], "-no-pcm") == 0)
+		{
+			settings.EnablePcm = false;
+		}
+	}
 
-	constexpr f32 cornerHalfHeight = 3.0f;
-	constexpr f32 cornerRadius = 4.0f;
-	constexpr f32 cornerPosition = boardSize - cornerRadius;
+	return settings;
+}
 
-	constexpr f32 capsuleDistance = cornerPosition + 4.0f;
-	constexpr f32 capsuleElevation = 2.0f;
-	constexpr f32 capsuleRadius = 2.0f;
-	constexpr f32 capsuleLength = 1.5f;
+// Loads the arena's assets once for every world that uses them. Without a renderer, they only keep
+// their CPU side data.
+ArenaAssets LoadArenaAssets(Vulkan::Renderer const* renderer, AssetManager& assetManager, i32 argc, char** argv)
+{
+	ArenaAssets assets;
 
-	constexpr f32 coneHeight = 8.0f;
-	constexpr f32 coneRadius = 5.0f;
+	assets.Manager = &assetManager;
 
-	constexpr f32 ballRadius = 1.0f;
+	assets.BoxMesh = Factory<StaticMesh>::MakeBox({ gBoardSize, gBoardSize, 1.0f }, renderer, assetManager);
+	assets.CylinderMesh = Factory<StaticMesh>::MakeCylinder(gCornerRadius, gCornerHalfHeight, renderer, assetManager);
+	assets.CapsuleMesh = Factory<StaticMesh>::MakeCapsule(gCapsuleRadius, gCapsuleLength, renderer, assetManager);
+	assets.ConeMesh = Factory<StaticMesh>::MakeCone(gConeRadius, gConeHeight, renderer, assetManager);
+	assets.BallMesh = Factory<StaticMesh>::MakeBall(gBallRadius, renderer, assetManager);
 
-	AssetManager assetManager;
+	// Snapshots and scene files refer to assets by name. Those loaded from files go by their path.
+	assetManager.SetName(assets.BoxMesh, "Box");
+	assetManager.SetName(assets.CylinderMesh, "Cylinder");
+	assetManager.SetName(assets.CapsuleMesh, "Capsule");
+	assetManager.SetName(assets.ConeMesh, "Cone");
+	assetManager.SetName(assets.BallMesh, "Ball");
 
-	AssetHandle<StaticMesh> boxMesh = Factory<StaticMesh>::MakeBox({ boardSize, boardSize, 1.0f }, renderer, assetManager);
-	AssetHandle<StaticMesh> cylinderMesh = Factory<StaticMesh>::MakeCylinder(cornerRadius, cornerHalfHeight, renderer, assetManager);
-	AssetHandle<StaticMesh> capsuleMesh = Factory<StaticMesh>::MakeCapsule(capsuleRadius, capsuleLength, renderer, assetManager);
-	AssetHandle<StaticMesh> coneMesh = Factory<StaticMesh>::MakeCone(coneRadius, coneHeight, renderer, assetManager);
-	AssetHandle<StaticMesh> ballMesh = Factory<StaticMesh>::MakeBall(ballRadius, renderer, assetManager);
+	if (const cstr obstaclePath = GetCommandLineString(argc, argv, "-obstacle-mesh"))
+		assets.ObstacleMesh = Factory<StaticMesh>::FromFile(obstaclePath, renderer, assetManager);
 
-	AssetHandle<Texture> spriteTexture = Factory<Texture>::FromFile("Textures/default.png", renderer, assetManager);
-	AssetHandle<Texture> cubeTexture = Factory<Texture>::FromFile("Textures/cube.png", renderer, assetManager);
-	AssetHandle<Texture> ballTexture = Factory<Texture>::FromFile("Textures/ball.png", renderer, assetManager);
-	AssetHandle<Texture> cylinderTexture = Factory<Texture>::FromFile("Textures/cylinder.png", renderer, assetManager);
-	AssetHandle<Texture> capsuleTexture = Factory<Texture>::FromFile("Textures/capsule.png", renderer, assetManager);
-	AssetHandle<Texture> coneTexture = Factory<Texture>::FromFile("Textures/cone.png", renderer, assetManager);
+	assets.SpriteTexture = Factory<Texture>::FromFile("Textures/default.png", renderer, assetManager);
+	assets.CubeTexture = Factory<Texture>::FromFile("Textures/cube.png", renderer, assetManager);
+	assets.BallTexture = Factory<Texture>::FromFile("Textures/ball.png", renderer, assetManager);
+	assets.CylinderTexture = Factory<Texture>::FromFile("Textures/cylinder.png", renderer, assetManager);
+	assets.CapsuleTexture = Factory<Texture>::FromFile("Textures/capsule.png", renderer, assetManager);
+	assets.ConeTexture = Factory<Texture>::FromFile("Textures/cone.png", renderer, assetManager);
 
-	AssetHandle<Font> fontArianaVioleta = Factory<Font>::FromFile("Fonts/ArianaVioleta-dz2K.ttf", renderer, assetManager);
-	AssetHandle<Font> fontOrbitron = Factory<Font>::FromFile("Fonts/Orbitron-Regular.ttf", renderer, assetManager);
+	assets.FontArianaVioleta = Factory<Font>::FromFile("Fonts/ArianaVioleta-dz2K.ttf", renderer, assetManager);
+	assets.FontOrbitron = Factory<Font>::FromFile("Fonts/Orbitron-Regular.ttf", renderer, assetManager);
 
-	GameWorld world(
-		std::make_unique<InputSystem>(window),
-		std::make_unique<PhysicsSystem>(),
-		std::make_unique<MeshRenderSystem>(renderer, shaderCompiler, assetManager),
-		std::make_unique<SpriteRenderSystem>(renderer, shaderCompiler, assetManager),
-		std::make_unique<TextRenderSystem>(renderer, shaderCompiler, assetManager));
+	return assets;
+}
+
+// Builds the arena, its paddles and the player's camera in the world, or loads them from
+// -load-snapshot <file>.
+void PopulateArena(GameWorld& world, const ArenaAssets& assets, i32 argc, char** argv)
+{
+	{
+		// Static level pieces and kinematic paddles never need to touch each other.
+		PhysicsCollisionMatrix collisionMatrix;
+		collisionMatrix.SetInteraction(PhysicsCollisionLayer::Level, PhysicsCollisionLayer::Paddle, false);
+		collisionMatrix.SetInteraction(PhysicsCollisionLayer::Paddle, PhysicsCollisionLayer::Paddle, false);
+
+		if (HasCommandLineSwitch(argc, argv, "-no-ball-collisions"))
+			collisionMatrix.SetInteraction(PhysicsCollisionLayer::Ball, PhysicsCollisionLayer::Ball, false);
+
+		world.GetPhysicsSystem().SetCollisionMatrix(collisionMatrix);
+	}
+
+	if (const cstr snapshotPath = GetCommandLineString(argc, argv, "-load-snapshot"))
+	{
+		if (WorldSnapshot::LoadFromFile(world, snapshotPath, assets.Manager))
+			return;
+
+		std::cout << "Cannot load the snapshot " << snapshotPath << ", building the default arena" << std::endl;
+	}
+
+	const bool useConvexHulls = HasCommandLineSwitch(argc, argv, "-convex-hulls");
+
+	// -scene <file> builds the world from a scene file instead, cooked next to the other cached files.
+	if (const cstr scenePath = GetCommandLineString(argc, argv, "-scene"))
+	{
+		const std::string cookedPath = "Cache/Scenes/" + std::filesystem::path(scenePath).stem().string() + (useConvexHulls ? ".convex.world" : ".world");
+
+		std::string error;
+		if (!SceneCooker::CookFileIfStale(scenePath, cookedPath.c_str(), error, useConvexHulls))
+			std::cout << "Cannot cook " << scenePath << ": " << error << std::endl;
+		else if (WorldSnapshot::LoadFromFile(world, cookedPath.c_str(), assets.Manager))
+			return;
+		else
+			std::cout << "Cannot load " << cookedPath << ", building the default arena" << std::endl;
+	}
 
 	PhysicsSystemMaterialPtr defaultMaterial = world.GetPhysicsSystem().CreateMaterial({ 0.2f, 0.1f, 1.0f });
 	PhysicsSystemMaterialPtr floorMaterial = world.GetPhysicsSystem().CreateMaterial({ 0.2f, 0.05f, 0.0f });
 	
-	std::shared_ptr<physx::PxGeometry> boxCollision = std::make_unique<physx::PxBoxGeometry>(boardSize, boardSize, 1.0f);
-	PhysicsRigidBodyParams boxRigidBodyParams = { PhysicsSystemObjectType::RigidStatic, nullptr, boxCollision, floorMaterial };
+	std::shared_ptr<physx::PxGeometry> boxCollision = std::make_unique<physx::PxBoxGeometry>(gBoardSize, gBoardSize, 1.0f);
+	PhysicsRigidBodyParams boxRigidBodyParams = { PhysicsSystemObjectType::RigidStatic, nullptr, boxCollision, floorMaterial, PhysicsCollisionLayer::Level };
 	
-	std::shared_ptr<physx::PxCustomGeometryExt::CylinderCallbacks> cylinderCollisionCallbacks = std::make_shared<physx::PxCustomGeometryExt::CylinderCallbacks>(2.0f * cornerHalfHeight, cornerRadius);
+	std::shared_ptr<physx::PxCustomGeometryExt::CylinderCallbacks> cylinderCollisionCallbacks = std::make_shared<physx::PxCustomGeometryExt::CylinderCallbacks>(2.0f * gCornerHalfHeight, gCornerRadius);
 	std::shared_ptr<physx::PxGeometry> cylinderCollision = std::make_shared<physx::PxCustomGeometry>(*cylinderCollisionCallbacks.get());
-	PhysicsRigidBodyParams cylinderRigidBodyParams = { PhysicsSystemObjectType::RigidStatic, cylinderCollisionCallbacks, cylinderCollision, defaultMaterial };
+	PhysicsRigidBodyParams cylinderRigidBodyParams = { PhysicsSystemObjectType::RigidStatic, cylinderCollisionCallbacks, cylinderCollision, defaultMaterial, PhysicsCollisionLayer::Level };
+	cylinderRigidBodyParams.UseConvexHull = useConvexHulls;
 	
-	std::shared_ptr<physx::PxGeometry> capsuleCollision = std::make_unique<physx::PxCapsuleGeometry>(capsuleRadius, capsuleLength);
-	PhysicsRigidBodyParams capsuleRigidBodyParams = { PhysicsSystemObjectType::RigidKinematic, nullptr, capsuleCollision, defaultMaterial };
+	std::shared_ptr<physx::PxGeometry> capsuleCollision = std::make_unique<physx::PxCapsuleGeometry>(gCapsuleRadius, gCapsuleLength);
+	PhysicsRigidBodyParams capsuleRigidBodyParams = { PhysicsSystemObjectType::RigidKinematic, nullptr, capsuleCollision, defaultMaterial, PhysicsCollisionLayer::Paddle };
 	
-	std::shared_ptr<physx::PxCustomGeometryExt::ConeCallbacks> coneCollisionCallbacks = std::make_shared<physx::PxCustomGeometryExt::ConeCallbacks>(coneHeight, coneRadius);
+	std::shared_ptr<physx::PxCustomGeometryExt::ConeCallbacks> coneCollisionCallbacks = std::make_shared<physx::PxCustomGeometryExt::ConeCallbacks>(gConeHeight, gConeRadius);
 	std::shared_ptr<physx::PxGeometry> coneCollision = std::make_shared<physx::PxCustomGeometry>(*coneCollisionCallbacks.get());
-	PhysicsRigidBodyParams coneRigidBodyParams = { PhysicsSystemObjectType::RigidStatic, coneCollisionCallbacks, coneCollision, defaultMaterial };
+	PhysicsRigidBodyParams coneRigidBodyParams = { PhysicsSystemObjectType::RigidStatic, coneCollisionCallbacks, coneCollision, defaultMaterial, PhysicsCollisionLayer::Level };
+	coneRigidBodyParams.UseConvexHull = useConvexHulls;
+
+	std::shared_ptr<physx::PxGeometry> ballCollision = std::make_unique<physx::PxSphereGeometry>(gBallRadius);
+	PhysicsRigidBodyParams ballRigidBodyParams = { PhysicsSystemObjectType::RigidDynamic, nullptr, ballCollision, defaultMaterial, PhysicsCollisionLayer::Ball };
 
-	std::shared_ptr<physx::PxGeometry> ballCollision = std::make_unique<physx::PxSphereGeometry>(ballRadius);
-	PhysicsRigidBodyParams ballRigidBodyParams = { PhysicsSystemObjectType::RigidDynamic, nullptr, ballCollision, defaultMaterial };
+	std::shared_ptr<physx::PxGeometry> killZoneCollision = std::make_unique<physx::PxBoxGeometry>(gKillZoneHalfSize, gKillZoneHalfSize, gKillZoneHalfHeight);
+	PhysicsRigidBodyParams killZoneRigidBodyParams = { PhysicsSystemObjectType::RigidStatic, nullptr, killZoneCollision, defaultMaterial, PhysicsCollisionLayer::Trigger };
+	killZoneRigidBodyParams.IsTrigger = true;
 
 	{
-		world.AddObject(CreateUserInterface(spriteTexture, fontArianaVioleta, fontOrbitron));
+		world.AddObject(CreateUserInterface(assets.SpriteTexture, assets.FontArianaVioleta, assets.FontOrbitron));
 
 		mage::Transform transform;
 
-		world.AddObject(CreateLevelObject(transform, boxRigidBodyParams, boxMesh, cubeTexture));
+		world.AddObject(CreateLevelObject(transform, boxRigidBodyParams, assets.BoxMesh, assets.CubeTexture));
+		world.AddObject(CreateKillZone(killZoneRigidBodyParams));
+
+		// The obstacle collides with its mesh's faces, or with their convex hull under -convex-hulls.
+		if (StaticMesh const* obstacleMesh = assets.ObstacleMesh.GetAsset())
+		{
+			PhysicsMeshCooker& meshCooker = world.GetPhysicsSystem().GetMeshCooker();
+			std::shared_ptr<physx::PxGeometry> obstacleCollision = useConvexHulls ? meshCooker.GetConvexMesh(*obstacleMesh) : meshCooker.GetTriangleMesh(*obstacleMesh);
+
+			if (obstacleCollision == nullptr)
+			{
+				std::cout << "Cannot cook a collision mesh for the obstacle, leaving it out" << std::endl;
+			}
+			else
+			{
+				PhysicsRigidBodyParams obstacleRigidBodyParams = { PhysicsSystemObjectType::RigidStatic, nullptr, obstacleCollision, defaultMaterial, PhysicsCollisionLayer::Level };
+
+				transform.Position = glm::vec3(0.0f, -0.5f * gCornerPosition, 1.0f);
+				world.AddObject(CreateLevelObject(transform, obstacleRigidBodyParams, assets.ObstacleMesh, assets.CubeTexture));
+				transform.Position = {};
+			}
+		}
 
 		transform.Position = glm::vec3(0.0f, -30.0f, 10.0f);
-		world.AddObject(CreateControllableCamera(transform, 10.0f, ballRigidBodyParams, ballMesh, ballTexture, 10.0f, GLFW_KEY_F));
+		world.AddObject(CreateControllableCamera(transform, 10.0f, ballRigidBodyParams, assets.BallMesh, assets.BallTexture, 10.0f, GLFW_KEY_F));
 		
 		transform.Rotation = mage::Rotor(glm::vec3(0.0f, 1.0f, 0.0f), glm::radians(90.0f));
 		
 		transform.Position = {};
-		world.AddObject(CreateLevelObject(transform, coneRigidBodyParams, coneMesh, coneTexture));
+		world.AddObject(CreateLevelObject(transform, coneRigidBodyParams, assets.ConeMesh, assets.ConeTexture));
 		
-		transform.Position = glm::vec3(cornerPosition, cornerPosition, cornerHalfHeight);
-		world.AddObject(CreateLevelObject(transform, cylinderRigidBodyParams, cylinderMesh, cylinderTexture));
+		transform.Position = glm::vec3(gCornerPosition, gCornerPosition, gCornerHalfHeight);
+		world.AddObject(CreateLevelObject(transform, cylinderRigidBodyParams, assets.CylinderMesh, assets.CylinderTexture));
 		
-		transform.Position = glm::vec3(-cornerPosition, cornerPosition, cornerHalfHeight);
-		world.AddObject(CreateLevelObject(transform, cylinderRigidBodyParams, cylinderMesh, cylinderTexture));
+		transform.Position = glm::vec3(-gCornerPosition, gCornerPosition, gCornerHalfHeight);
+		world.AddObject(CreateLevelObject(transform, cylinderRigidBodyParams, assets.CylinderMesh, assets.CylinderTexture));
 		
-		transform.Position = glm::vec3(-cornerPosition, -cornerPosition, cornerHalfHeight);
-		world.AddObject(CreateLevelObject(transform, cylinderRigidBodyParams, cylinderMesh, cylinderTexture));
+		transform.Position = glm::vec3(-gCornerPosition, -gCornerPosition, gCornerHalfHeight);
+		world.AddObject(CreateLevelObject(transform, cylinderRigidBodyParams, assets.CylinderMesh, assets.CylinderTexture));
 		
-		transform.Position = glm::vec3(cornerPosition, -cornerPosition, cornerHalfHeight);
-		world.AddObject(CreateLevelObject(transform, cylinderRigidBodyParams, cylinderMesh, cylinderTexture));
+		transform.Position = glm::vec3(gCornerPosition, -gCornerPosition, gCornerHalfHeight);
+		world.AddObject(CreateLevelObject(transform, cylinderRigidBodyParams, assets.CylinderMesh, assets.CylinderTexture));
 		
 		transform.Rotation = {};
-		transform.Position = glm::vec3(-capsuleDistance, 0.0f, capsuleElevation);
-		world.AddObject(CreateCapsule(transform, capsuleRigidBodyParams, capsuleMesh, capsuleTexture, GLFW_KEY_H, GLFW_KEY_J));
+		transform.Position = glm::vec3(-gCapsuleDistance, 0.0f, gCapsuleElevation);
+		world.AddObject(CreateCapsule(transform, capsuleRigidBodyParams, assets.CapsuleMesh, assets.CapsuleTexture, GLFW_KEY_H, GLFW_KEY_J));
 		
 		transform.Rotation = mage::Rotor(glm::vec3(0.0f, 0.0f, 1.0f), glm::radians(90.0f));
-		transform.Position = glm::vec3(0.0f, capsuleDistance, capsuleElevation);
-		world.AddObject(CreateCapsule(transform, capsuleRigidBodyParams, capsuleMesh, capsuleTexture, GLFW_KEY_U, GLFW_KEY_I));
+		transform.Position = glm::vec3(0.0f, gCapsuleDistance, gCapsuleElevation);
+		world.AddObject(CreateCapsule(transform, capsuleRigidBodyParams, assets.CapsuleMesh, assets.CapsuleTexture, GLFW_KEY_U, GLFW_KEY_I));
 		
 		transform.Rotation = mage::Rotor(glm::vec3(0.0f, 0.0f, 1.0f), glm::radians(180.0f));
-		transform.Position = glm::vec3(capsuleDistance, 0.0f, capsuleElevation);
-		world.AddObject(CreateCapsule(transform, capsuleRigidBodyParams, capsuleMesh, capsuleTexture, GLFW_KEY_O, GLFW_KEY_P));
+		transform.Position = glm::vec3(gCapsuleDistance, 0.0f, gCapsuleElevation);
+		world.AddObject(CreateCapsule(transform, capsuleRigidBodyParams, assets.CapsuleMesh, assets.CapsuleTexture, GLFW_KEY_O, GLFW_KEY_P));
 		
 		transform.Rotation = mage::Rotor(glm::vec3(0.0f, 0.0f, 1.0f), glm::radians(-90.0f));
-		transform.Position = glm::vec3(0.0f, -capsuleDistance, capsuleElevation);
-		world.AddObject(CreateCapsule(transform, capsuleRigidBodyParams, capsuleMesh, capsuleTexture, GLFW_KEY_K, GLFW_KEY_L));
+		transform.Position = glm::vec3(0.0f, -gCapsuleDistance, gCapsuleElevation);
+		world.AddObject(CreateCapsule(transform, capsuleRigidBodyParams, assets.CapsuleMesh, assets.CapsuleTexture, GLFW_KEY_K, GLFW_KEY_L));
+	}
+}
+
+// Runs the benchmark named after -benchmark on the command line instead of the game.
+std::optional<i32> RunBenchmarkFromCommandLine(i32 argc, char** argv)
+{
+	for (i32 i = 1; i + 1 < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-benchmark") != 0)
+			continue;
+
+		if (std::strcmp(argv[i + 1], "jobs") == 0)
+			return RunJobSystemBenchmark();
+
+		if (std::strcmp(argv[i + 1], "physics") == 0)
+			return RunPhysicsBenchmark();
+
+		if (std::strcmp(argv[i + 1], "primitives") == 0)
+			return RunPrimitiveCollisionBenchmark();
+
+		if (std::strcmp(argv[i + 1], "stress") == 0)
+		{
+			const u32 arenaCount = std::max(GetCommandLineValue(argc, argv, "-arenas", 1), 1u);
+			const u32 ballCount = GetCommandLineValue(argc, argv, "-balls", 4000);
+			const u32 stepCount = GetCommandLineValue(argc, argv, "-steps", 600);
+
+			return RunPhysicsStressBenchmark(GetJobSystemSettingsFromCommandLine(argc, argv), GetPhysicsSystemSettingsFromCommandLine(argc, argv), arenaCount, ballCount, stepCount);
+		}
+
+		if (std::strcmp(argv[i + 1], "replication") == 0)
+			return RunReplicationBenchmark(std::max(GetCommandLineValue(argc, argv, "-objects", 10000), 1u), std::max(GetCommandLineValue(argc, argv, "-steps", 600), 1u));
+
+		return 1;
+	}
+
+	return std::nullopt;
+}
+
+// -cook-scene <scene> <output> turns a scene file into the world snapshot that -load-snapshot reads,
+// honouring -convex-hulls as -scene does.
+std::optional<i32> RunSceneCookerFromCommandLine(i32 argc, char** argv)
+{
+	for (i32 i = 1; i + 2 < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-cook-scene") != 0)
+			continue;
+
+		std::string error;
+		if (!SceneCooker::CookFile(argv[i + 1], argv[i + 2], error, HasCommandLineSwitch(argc, argv, "-convex-hulls")))
+		{
+			std::cout << "Cannot cook " << argv[i + 1] << ": " << error << std::endl;
+			return 1;
+		}
+
+		return 0;
+	}
+
+	return std::nullopt;
+}
+
+// Runs -worlds copies of the arena without a window or renderer when -headless is on the command line,
+// and reports how long each tick of all worlds took. The worlds share one set of arena assets, and take
+// -async-physics and -parallel-updates as the windowed world does. They are driven by scripted input, or by a
+// session recorded with -record when -replay <file> is given. With -rollback <frames>, every world is
+// rewound that many frames once a second and resimulated with the same input, as late remote input would.
+// With -replicate <port>, it first waits for a viewer started with -receive-replication <port> to connect
+// on the loopback interface, then streams the first world's rigid bodies to it after every tick.
+std::optional<i32> RunHeadlessFromCommandLine(i32 argc, char** argv)
+{
+	const cstr replayPath = GetCommandLineString(argc, argv, "-replay");
+	if (!HasCommandLineSwitch(argc, argv, "-headless") && replayPath == nullptr)
+		return std::nullopt;
+
+	constexpr f32 cTimeStep = 1.0f / 60.0f;
+	constexpr u32 cSpawnInterval = 30;
+	constexpr u32 cPaddleInterval = 120;
+	constexpr u32 cRollbackInterval = 60;
+
+	InputReplay replay;
+	if (replayPath != nullptr && !replay.LoadFromFile(replayPath))
+	{
+		std::cout << "Cannot replay " << replayPath << std::endl;
+		return 1;
+	}
+
+	const u32 worldCount = std::max(GetCommandLineValue(argc, argv, "-worlds", replayPath != nullptr ? 1 : 8), 1u);
+	const u32 stepCount = replayPath != nullptr ? replay.GetFrameCount() : GetCommandLineValue(argc, argv, "-steps", 600);
+	const u32 rollbackFrameCount = GetCommandLineValue(argc, argv, "-rollback", 0);
+	const bool isAsyncPhysics = HasCommandLineSwitch(argc, argv, "-async-physics");
+
+	if (rollbackFrameCount > 0 && isAsyncPhysics)
+	{
+		std::cout << "-rollback cannot be combined with -async-physics" << std::endl;
+		return 1;
+	}
+
+	mage::JobSystem jobSystem(GetJobSystemSettingsFromCommandLine(argc, argv));
+	GameWorldHost host(jobSystem, GetPhysicsSystemSettingsFromCommandLine(argc, argv));
+
+	AssetManager assetManager;
+	const ArenaAssets assets = LoadArenaAssets(nullptr, assetManager, argc, argv);
+
+	mage::Array<std::unique_ptr<WorldRollback>> rollbacks;
+
+	const u32 replicationPort = GetCommandLineValue(argc, argv, "-replicate", 0);
+	ReplicationConnection replicationConnection;
+	if (replicationPort != 0)
+	{
+		std::cout << "Waiting for a viewer on port " << replicationPort << std::endl;
+
+		if (replicationPort > UINT16_MAX || !replicationConnection.Accept(u16(replicationPort)))
+		{
+			std::cout << "Cannot replicate on port " << replicationPort << std::endl;
+			return 1;
+		}
+	}
+
+	for (u32 i = 0; i < worldCount; ++i)
+	{
+		GameWorld& world = host.CreateWorld();
+
+		if (!HasCommandLineSwitch(argc, argv, "-variable-timestep"))
+			world.SetFixedTimestep(cTimeStep, 4);
+
+		if (isAsyncPhysics)
+			world.SetAsyncPhysics(true);
+
+		// Each world's updates fan out further on the job system that already runs the worlds.
+		if (HasCommandLineSwitch(argc, argv, "-parallel-updates"))
+			world.SetParallelUpdateJobSystem(&jobSystem);
+
+		PopulateArena(world, assets, argc, argv);
+
+		if (rollbackFrameCount > 0)
+			rollbacks.Add(std::make_unique<WorldRollback>(world, rollbackFrameCount + 1));
+	}
+
+	std::cout << "Headless: " << worldCount << " worlds, " << stepCount << " steps, " << jobSystem.GetThreadCount() << " threads" << std::endl;
+
+	std::optional<ReplicationSource> replicationSource;
+	if (replicationPort != 0)
+		replicationSource.emplace(host.GetWorld(0));
+
+	ReplicationEncoder replicationEncoder;
+	mage::Array<u8> replicationMessage;
+	u64 replicatedBytes = 0;
+
+	mage::Array<f64> tickTimes;
+	tickTimes.Reserve(stepCount);
+
+	mage::Array<f64> rollbackTimes;
+	mage::Array<InputFrame> inputHistory;
+
+	InputFrame frame;
+
+	for (u32 step = 0; step < stepCount; ++step)
+	{
+		if (replayPath != nullptr)
+		{
+			if (!replay.ReadFrame(frame))
+			{
+				std::cout << "Replay ended early at frame " << step << std::endl;
+				break;
+			}
+		}
+		else
+		{
+			// Every world gets the same script: spawn balls at a steady rate and sweep one paddle back and forth.
+			const bool isPaddleForward = (step / cPaddleInterval) % 2 == 0;
+
+			frame.DeltaTime = cTimeStep;
+			frame.Events.Empty();
+			frame.Events.Add({ .Type = InputEventType::Key, .Key = GLFW_KEY_F, .Action = step % cSpawnInterval == 0 ? GLFW_PRESS : GLFW_RELEASE });
+			frame.Events.Add({ .Type = InputEventType::Key, .Key = GLFW_KEY_H, .Action = isPaddleForward ? GLFW_RELEASE : GLFW_PRESS });
+			frame.Events.Add({ .Type = InputEventType::Key, .Key = GLFW_KEY_J, .Action = isPaddleForward ? GLFW_PRESS : GLFW_RELEASE });
+		}
+
+		for (u32 i = 0; i < host.GetWorldCount(); ++i)
+			frame.Apply(host.GetWorld(i).GetInputSystem());
+
+		const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+		host.Update(frame.DeltaTime);
+
+		const std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+		tickTimes.Add(std::chrono::duration<f64, std::milli>(endTime - startTime).count());
+
+		if (replicationSource)
+		{
+			replicationEncoder.Encode(replicationSource->Gather(), replicationMessage);
+
+			if (!replicationConnection.Send(replicationMessage))
+			{
+				std::cout << "Lost the viewer at step " << step << std::endl;
+				return 1;
+			}
+
+			replicatedBytes += sizeof(u32) + replicationMessage.GetSize();
+		}
+
+		if (rollbackFrameCount == 0)
+			continue;
+
+		inputHistory.Add(frame);
+
+		if ((step + 1) % cRollbackInterval == 0 && inputHistory.GetSize() > rollbackFrameCount)
+		{
+			const InputFrame* inputs = inputHistory.GetData() + inputHistory.GetSize() - rollbackFrameCount;
+
+			const std::chrono::steady_clock::time_point rollbackStartTime = std::chrono::steady_clock::now();
+
+			jobSystem.ParallelFor(rollbacks, [inputs, rollbackFrameCount](const std::unique_ptr<WorldRollback>& rollback)
+				{ mage_ensure(rollback->Resimulate(rollback->GetLatestFrame() - rollbackFrameCount, inputs, rollbackFrameCount)); }, 1);
+
+			const std::chrono::steady_clock::time_point rollbackEndTime = std::chrono::steady_clock::now();
+			rollbackTimes.Add(std::chrono::duration<f64, std::milli>(rollbackEndTime - rollbackStartTime).count());
+		}
+	}
+
+	const cstr snapshotPath = GetCommandLineString(argc, argv, "-save-snapshot");
+	if (snapshotPath != nullptr && !WorldSnapshot::SaveToFile(host.GetWorld(0), snapshotPath))
+	{
+		std::cout << "Cannot save the snapshot to " << snapshotPath << std::endl;
+		return 1;
 	}
 
+	tickTimes.Sort();
+
+	f64 totalTime = 0.0;
+	for (f64 time : tickTimes)
+		totalTime += time;
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "Tick ms: mean " << totalTime / f64(std::max(tickTimes.GetSize(), 1u))
+		<< ", p50 " << Benchmark::GetPercentile(tickTimes, 50.0)
+		<< ", p99 " << Benchmark::GetPercentile(tickTimes, 99.0)
+		<< ", max " << Benchmark::GetPercentile(tickTimes, 100.0) << std::endl;
+
+	if (!rollbackTimes.IsEmpty())
+	{
+		rollbackTimes.Sort();
+
+		std::cout << "Rollback of " << rollbackFrameCount << " frames ms: p50 " << Benchmark::GetPercentile(rollbackTimes, 50.0)
+			<< ", max " << Benchmark::GetPercentile(rollbackTimes, 100.0) << std::endl;
+	}
+
+	if (replicationSource)
+		std::cout << "Replicated bytes per tick: " << f64(replicatedBytes) / f64(std::max(tickTimes.GetSize(), 1u)) << std::endl;
+
+	return 0;
+}
+
+// -receive-replication <port> connects to a headless run started with -replicate <port>, decodes what it
+// streams until it closes the connection, and reports how many objects the messages held and how large
+// they were.
+std::optional<i32> RunReplicationReceiverFromCommandLine(i32 argc, char** argv)
+{
+	const u32 receivePort = GetCommandLineValue(argc, argv, "-receive-replication", 0);
+	if (receivePort == 0)
+		return std::nullopt;
+
+	ReplicationConnection connection;
+	if (receivePort > UINT16_MAX || !connection.Connect(u16(receivePort)))
+	{
+		std::cout << "Cannot receive from port " << receivePort << std::endl;
+		return 1;
+	}
+
+	ReplicationDecoder decoder;
+	mage::Array<u8> message;
+	u64 messageCount = 0;
+	u64 totalBytes = 0;
+
+	while (connection.Receive(message))
+	{
+		if (!decoder.Decode(message.GetData(), message.GetSize()))
+		{
+			std::cout << "Bad replication message " << messageCount << std::endl;
+			return 1;
+		}
+
+		++messageCount;
+		totalBytes += sizeof(u32) + message.GetSize();
+	}
+
+	if (connection.HasFailed())
+	{
+		std::cout << "Replication stream broke after " << messageCount << " messages" << std::endl;
+		return 1;
+	}
+
+	std::cout << std::fixed << std::setprecision(1) << "Received " << messageCount << " messages, "
+		<< f64(totalBytes) / f64(std::max(messageCount, u64(1))) << " bytes each, "
+		<< decoder.GetObjects().GetSize() << " objects at the end" << std::endl;
+
+	return 0;
+}
+
+i32 main(i32 argc, char** argv)
+{
+	if (const std::optional<i32> benchmarkResult = RunBenchmarkFromCommandLine(argc, argv))
+		return *benchmarkResult;
+
+	if (const std::optional<i32> cookerResult = RunSceneCookerFromCommandLine(argc, argv))
+		return *cookerResult;
+
+	if (const std::optional<i32> headlessResult = RunHeadlessFromCommandLine(argc, argv))
+		return *headlessResult;
+
+	if (const std::optional<i32> receiverResult = RunReplicationReceiverFromCommandLine(argc, argv))
+		return *receiverResult;
+
+	Vulkan::WindowInfo windowCreateInfo
+	{
+		.Name = "Merely Another Game Engine",
+		.Width = gWindowWidth,
+		.Height = gWindowHeight
+	};
+
+	Vulkan::Instance vulkan;
+	Vulkan::Window window = vulkan.CreateWindow(windowCreateInfo);
+	Vulkan::Renderer renderer{ vulkan, window };
+
+	Vulkan::ShaderCompiler shaderCompiler;
+
+	mage::JobSystem jobSystem(GetJobSystemSettingsFromCommandLine(argc, argv));
+
+	AssetManager assetManager;
+
+	const ArenaAssets assets = LoadArenaAssets(&renderer, assetManager, argc, argv);
+
+	GameWorld world(
+		std::make_unique<InputSystem>(window),
+		std::make_unique<PhysicsSystem>(jobSystem, GetPhysicsSystemSettingsFromCommandLine(argc, argv)),
+		std::make_unique<MeshRenderSystem>(renderer, shaderCompiler, assetManager),
+		std::make_unique<SpriteRenderSystem>(renderer, shaderCompiler, assetManager),
+		std::make_unique<TextRenderSystem>(renderer, shaderCompiler, assetManager));
+
+	if (!HasCommandLineSwitch(argc, argv, "-variable-timestep"))
+		world.SetFixedTimestep(1.0f / 60.0f, 4);
+
+	if (HasCommandLineSwitch(argc, argv, "-async-physics"))
+		world.SetAsyncPhysics(true);
+
+	if (HasCommandLineSwitch(argc, argv, "-parallel-updates"))
+		world.SetParallelUpdateJobSystem(&jobSystem);
+
+	PopulateArena(world, assets, argc, argv);
+
+	// -record <file> saves the session's input for replaying it headless with -replay <file>.
+	const cstr recordPath = GetCommandLineString(argc, argv, "-record");
+	InputRecorder recorder;
+	if (recordPath != nullptr)
+		world.GetInputSystem().SetRecorder(&recorder);
+
 	std::chrono::steady_clock::time_point currentTime = std::chrono::high_resolution_clock::now();
 
 	world.GetInputSystem().BindKeyInputHandler(GLFW_KEY_LEFT_CONTROL, GLFW_PRESS, [&window]() { window.SetCursorInputMode(GLFW_CURSOR_NORMAL); });
@@ -291,6 +849,9 @@ i32 main()
 		const f32 frameTime = std::chrono::duration<f32, std::chrono::seconds::period>(newTime - currentTime).count();
 		currentTime = newTime;
 
+		if (recordPath != nullptr)
+			recorder.EndFrame(frameTime);
+
 		world.Update(frameTime);
 
 		world.Render(renderer);
@@ -298,5 +859,12 @@ i32 main()
 
 	renderer.WaitIdle();
 
+	const cstr snapshotPath = GetCommandLineString(argc, argv, "-save-snapshot");
+	if (snapshotPath != nullptr && !WorldSnapshot::SaveToFile(world, snapshotPath))
+		std::cout << "Cannot save the snapshot to " << snapshotPath << std::endl;
+
+	if (recordPath != nullptr && !recorder.SaveToFile(recordPath))
+		std::cout << "Cannot save the recording to " << recordPath << std::endl;
+
 	return 0;
 }
@@ -0,0 +1,199 @@
+#include "Physics/PhysicsAllocator.h"
+
+PhysicsAllocator::~PhysicsAllocator()
+{
+	for (void* chunk : mChunks)
+		_aligned_free(chunk);
+}
+
+void* PhysicsAllocator::allocate(size_t size, const char* typeName, const char* filename, int line)
+{
+	const u64 blockSize = u64(size) + sizeof(BlockHeader);
+	const u32 sizeClass = GetSizeClass(blockSize);
+
+	void* block = sizeClass == cLargeSizeClass ? AllocateFromSystem(blockSize) : AllocateFromPool(sizeClass);
+	if (!block)
+		return nullptr;
+
+	const u32 category = GetCategory(typeName);
+
+	Category& stats = mCategories[category];
+	stats.LiveBytes.fetch_add(size, std::memory_order_relaxed);
+	stats.LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+	stats.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	BlockHeader* header = static_cast<BlockHeader*>(block);
+	*header = { sizeClass, category, u64(size) };
+
+	return header + 1;
+}
+
+void PhysicsAllocator::deallocate(void* ptr)
+{
+	if (!ptr)
+		return;
+
+	BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+
+	Category& stats = mCategories[header->Category];
+	stats.LiveBytes.fetch_sub(header->Size, std::memory_order_relaxed);
+	stats.LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+	if (header->SizeClass == cLargeSizeClass)
+	{
+		mSystemBytes.fetch_sub(header->Size + sizeof(BlockHeader));
+		_aligned_free(header);
+		return;
+	}
+
+	Pool& pool = mPools[header->SizeClass];
+	FreeBlock* freeBlock = reinterpret_cast<FreeBlock*>(header);
+
+	std::lock_guard lock(pool.Mutex);
+	freeBlock->Next = pool.FreeList;
+	pool.FreeList = freeBlock;
+}
+
+mage::Array<PhysicsAllocationStats> PhysicsAllocator::GetStats() const
+{
+	const u32 categoryCount = mCategoryCount.load(std::memory_order_acquire);
+
+	mage::Array<PhysicsAllocationStats> stats;
+	stats.Reserve(categoryCount);
+
+	for (u32 i = 0; i < categoryCount; ++i)
+	{
+		const Category& category = mCategories[i];
+		stats.Add({ category.TypeName, category.LiveBytes.load(std::memory_order_relaxed), category.LiveAllocations.load(std::memory_order_relaxed), category.TotalAllocations.load(std::memory_order_relaxed) });
+	}
+
+	std::sort(stats.begin(), stats.end(), [](const PhysicsAllocationStats& a, const PhysicsAllocationStats& b) { return a.LiveBytes > b.LiveBytes; });
+
+	return stats;
+}
+
+u32 PhysicsAllocator::GetSizeClass(u64 blockSize)
+{
+	for (u32 sizeClass = 0; sizeClass < cSizeClassCount; ++sizeClass)
+		if (blockSize <= GetBlockSize(sizeClass))
+			return sizeClass;
+
+	return cLargeSizeClass;
+}
+
+void* PhysicsAllocator::AllocateFromPool(u32 sizeClass)
+{
+	Pool& pool = mPools[sizeClass];
+
+	{
+		std::lock_guard lock(pool.Mutex);
+
+		if (FreeBlock* freeBlock = pool.FreeList)
+		{
+			pool.FreeList = freeBlock->Next;
+			return freeBlock;
+		}
+	}
+
+	// Carve a new chunk into blocks, keep the first and pool the rest.
+	u8* chunk = static_cast<u8*>(_aligned_malloc(cChunkSize, 16));
+	if (!chunk)
+		return nullptr;
+
+	mSystemBytes.fetch_add(cChunkSize);
+	mSystemAllocationCount.fetch_add(1);
+
+	{
+		std::lock_guard lock(mChunksMutex);
+		mChunks.Add(chunk);
+	}
+
+	const u64 blockSize = GetBlockSize(sizeClass);
+	const u64 blockCount = cChunkSize / blockSize;
+
+	std::lock_guard lock(pool.Mutex);
+
+	for (u64 i = blockCount - 1; i > 0; --i)
+	{
+		FreeBlock* freeBlock = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+		freeBlock->Next = pool.FreeList;
+		pool.FreeList = freeBlock;
+	}
+
+	return chunk;
+}
+
+void* PhysicsAllocator::AllocateFromSystem(u64 size)
+{
+	void* block = _aligned_malloc(size, 16);
+	if (!block)
+		return nullptr;
+
+	mSystemBytes.fetch_add(size);
+	mSystemAllocationCount.fetch_add(1);
+
+	return block;
+}
+
+u32 PhysicsAllocator::GetCategory(const char* typeName)
+{
+	if (!typeName)
+		typeName = "<unnamed>";
+
+	const u64 firstSlot = std::hash<const char*>{}(typeName) % cCategorySlotCount;
+
+	for (u64 i = 0; i < cCategorySlotCount; ++i)
+	{
+		const u64 slot = (firstSlot + i) % cCategorySlotCount;
+		const char* slotTypeName = mSlotTypeNames[slot].load(std::memory_order_acquire);
+
+		if (slotTypeName == typeName)
+			return mSlotCategories[slot];
+
+		if (!slotTypeName)
+			break;
+	}
+
+	return AddCategory(typeName);
+}
+
+u32 PhysicsAllocator::AddCategory(const char* typeName)
+{
+	std::lock_guard lock(mCategoriesMutex);
+
+	auto [nameIt, isNew] = mCategoriesByName.try_emplace(typeName, 0);
+	if (isNew)
+	{
+		const u32 categoryCount = mCategoryCount.load(std::memory_order_relaxed);
+
+		if (categoryCount < cMaxCategoryCount)
+		{
+			mCategories[categoryCount].TypeName = nameIt->first.c_str();
+			mCategoryCount.store(categoryCount + 1, std::memory_order_release);
+		}
+
+		nameIt->second = std::min(categoryCount, cMaxCategoryCount - 1);
+	}
+
+	// Publish the pointer, unless another thread did while this one waited for the lock. A full table
+	// leaves later pointers to this slow path.
+	const u64 firstSlot = std::hash<const char*>{}(typeName) % cCategorySlotCount;
+
+	for (u64 i = 0; i < cCategorySlotCount; ++i)
+	{
+		const u64 slot = (firstSlot + i) % cCategorySlotCount;
+		const char* slotTypeName = mSlotTypeNames[slot].load(std::memory_order_relaxed);
+
+		if (slotTypeName == typeName)
+			break;
+
+		if (!slotTypeName)
+		{
+			mSlotCategories[slot] = nameIt->second;
+			mSlotTypeNames[slot].store(typeName, std::memory_order_release);
+			break;
+		}
+	}
+
+	return nameIt->second;
+}
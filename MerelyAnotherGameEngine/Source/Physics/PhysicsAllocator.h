@@ -0,0 +1,106 @@
+#pragma once
+
+#include <foundation/PxAllocatorCallback.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct PhysicsAllocationStats
+{
+	// Owned by the allocator.
+	const char* TypeName = nullptr;
+	u64 LiveBytes = 0;
+	u64 LiveAllocations = 0;
+	u64 TotalAllocations = 0;
+};
+
+// Serves PhysX allocations from power-of-two size class pools, which keep their blocks once freed,
+// so that a scene in steady state stops asking the system for memory. Larger allocations go to
+// the system directly. Tracks live memory per PhysX type name with atomic counters, so that only
+// chunk refills and new type names take a lock besides the size class's own free list.
+class PhysicsAllocator : public physx::PxAllocatorCallback, public NonCopyableClass
+{
+public:
+	PhysicsAllocator() {}
+
+	~PhysicsAllocator();
+
+	void* allocate(size_t size, const char* typeName, const char* filename, int line) override;
+	void deallocate(void* ptr) override;
+
+	// Sorted by live bytes, largest first.
+	mage::Array<PhysicsAllocationStats> GetStats() const;
+
+	// Memory held from the system, pooled or not, and the number of times it was asked for more.
+	u64 GetSystemBytes() const { return mSystemBytes.load(); }
+	u64 GetSystemAllocationCount() const { return mSystemAllocationCount.load(); }
+
+private:
+	struct BlockHeader
+	{
+		u32 SizeClass;
+		u32 Category;
+		u64 Size;
+	};
+
+	static_assert(sizeof(BlockHeader) == 16, "PhysX expects 16 byte aligned allocations.");
+
+	struct FreeBlock
+	{
+		FreeBlock* Next;
+	};
+
+	struct Pool
+	{
+		std::mutex Mutex;
+		FreeBlock* FreeList = nullptr;
+	};
+
+	static constexpr u32 cMinBlockSizeLog2 = 5;
+	static constexpr u32 cSizeClassCount = 10;
+	static constexpr u32 cLargeSizeClass = cSizeClassCount;
+	static constexpr u64 cChunkSize = 64 * 1024;
+
+	static u32 GetSizeClass(u64 blockSize);
+	static u64 GetBlockSize(u32 sizeClass) { return u64(1) << (cMinBlockSizeLog2 + sizeClass); }
+
+	void* AllocateFromPool(u32 sizeClass);
+	void* AllocateFromSystem(u64 size);
+
+	// Lock-free once the type name has been seen, which it has after the first few frames.
+	u32 GetCategory(const char* typeName);
+	u32 AddCategory(const char* typeName);
+
+	Pool mPools[cSizeClassCount];
+	mage::Array<void*> mChunks;
+	std::mutex mChunksMutex;
+
+	std::atomic<u64> mSystemBytes = 0;
+	std::atomic<u64> mSystemAllocationCount = 0;
+
+	struct Category
+	{
+		const char* TypeName = nullptr;
+		std::atomic<u64> LiveBytes = 0;
+		std::atomic<u64> LiveAllocations = 0;
+		std::atomic<u64> TotalAllocations = 0;
+	};
+
+	// PhysX names a few dozen types; any beyond the last category are counted in it.
+	static constexpr u32 cMaxCategoryCount = 256;
+	static constexpr u32 cCategorySlotCount = 1024;
+
+	Category mCategories[cMaxCategoryCount];
+	std::atomic<u32> mCategoryCount = 0;
+
+	// Open addressed by type name pointer, as type names are usually string literals. A slot's
+	// category is written before its pointer is published, and slots are never reused.
+	std::atomic<const char*> mSlotTypeNames[cCategorySlotCount] = {};
+	u32 mSlotCategories[cCategorySlotCount] = {};
+
+	// Only taken for type name pointers that are not in the slots yet.
+	std::mutex mCategoriesMutex;
+	std::unordered_map<std::string, u32> mCategoriesByName;
+};
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <memory>
 
+#include <Foundation/PxBounds3.h>
 #include <Foundation/PxTransform.h>
 #include <Geometry/PxCustomGeometry.h>
 
@@ -13,6 +14,84 @@ enum class PhysicsSystemObjectType : u8
 	RigidDynamic
 };
 
+enum class PhysicsCollisionLayer : u8
+{
+	Default,
+	Level,
+	Paddle,
+	Ball,
+	Trigger,
+
+	Count
+};
+
+// Which layers interact with which. Starts with every pair of layers interacting.
+class PhysicsCollisionMatrix
+{
+public:
+	PhysicsCollisionMatrix()
+	{
+		for (u32& mask : mMasks)
+			mask = ~0u;
+	}
+
+	void SetInteraction(PhysicsCollisionLayer layerA, PhysicsCollisionLayer layerB, bool interacts)
+	{
+		SetBit(mMasks[u32(layerA)], u32(layerB), interacts);
+		SetBit(mMasks[u32(layerB)], u32(layerA), interacts);
+	}
+
+	bool Interacts(u32 layerA, u32 layerB) const
+	{
+		return layerA < cLayerCount && layerB < cLayerCount && (mMasks[layerA] & (1u << layerB)) != 0;
+	}
+
+private:
+	static constexpr u32 cLayerCount = u32(PhysicsCollisionLayer::Count);
+	static_assert(cLayerCount <= 32);
+
+	static void SetBit(u32& mask, u32 bit, bool value)
+	{
+		mask = value ? mask | (1u << bit) : mask & ~(1u << bit);
+	}
+
+	u32 mMasks[cLayerCount];
+};
+
+enum class PhysicsSolverType : u8
+{
+	PGS,
+	TGS
+};
+
+enum class PhysicsBroadPhaseType : u8
+{
+	SAP,
+	MBP,
+	ABP,
+	PABP
+};
+
+// Scene description options. The defaults are PhysX's own.
+struct PhysicsSystemSettings
+{
+	PhysicsSolverType Solver = PhysicsSolverType::PGS;
+
+	PhysicsBroadPhaseType BroadPhase = PhysicsBroadPhaseType::PABP;
+
+	// Persistent contact manifolds, cheaper and more stable than regenerating contacts every step.
+	bool EnablePcm = true;
+
+	// Multi box pruning only: the world is split into a grid of broadphase regions over these
+	// bounds. Objects outside every region are dropped from the broadphase.
+	physx::PxBounds3 WorldBounds = physx::PxBounds3(physx::PxVec3(-100.0f), physx::PxVec3(100.0f));
+	u32 BroadPhaseRegionsPerAxis = 4;
+
+	// Memory kept for each step's temporary data, a multiple of 16 KB. PhysX allocates whatever
+	// does not fit. Zero leaves it all to the allocator.
+	u32 ScratchBlockSize = 64 * 16 * 1024;
+};
+
 struct PhysicsSystemMaterialProperties
 {
 	f32 StaticFriction;
@@ -20,6 +99,74 @@ struct PhysicsSystemMaterialProperties
 	f32 Restitution;
 };
 
+namespace physx
+{
+	class PxRigidDynamic;
+}
+
+class PhysicsActorListener;
+
+enum class PhysicsContactEventType : u8
+{
+	Begin,
+	End
+};
+
+struct PhysicsContactEvent
+{
+	PhysicsContactEventType Type;
+
+	PhysicsActorListener* Other;
+
+	// First contact point, with the normal pointing from the other actor towards the receiving one.
+	// Both are zero when PhysX reported no contact points, as for ended contacts.
+	physx::PxVec3 Position;
+	physx::PxVec3 Normal;
+};
+
+enum class PhysicsTriggerEventType : u8
+{
+	Enter,
+	Leave
+};
+
+struct PhysicsTriggerEvent
+{
+	PhysicsTriggerEventType Type;
+
+	PhysicsActorListener* Other;
+
+	// Whether the receiving actor is the trigger, as opposed to the actor entering or leaving it.
+	bool IsOwnTrigger;
+};
+
+// Stored as the userData of an actor, so that the physics system can push the actor's state back
+// after steps in which it moved, instead of every actor being polled every step.
+class PhysicsActorListener
+{
+public:
+	virtual ~PhysicsActorListener() = default;
+
+	// The actor was reported active by the last step.
+	virtual void OnPhysicsActorMoved(physx::PxRigidDynamic& actor) = 0;
+
+	// The actor moved in the step before the last one, but not in the last one.
+	virtual void OnPhysicsActorStopped(physx::PxRigidDynamic& actor) = 0;
+
+	// Contacts are only reported for actors created with ReportContacts, triggers for all actors.
+	virtual void OnPhysicsContact(const PhysicsContactEvent& event) {}
+
+	virtual void OnPhysicsTrigger(const PhysicsTriggerEvent& event) {}
+
+private:
+	friend class PhysicsSystem;
+
+	static constexpr u32 cNotMoving = ~0u;
+
+	u32 mMovingIndex = cNotMoving;
+	u64 mLastMovedStep = 0;
+};
+
 struct PhysicsSystemMaterial;
 using PhysicsSystemMaterialPtr = std::shared_ptr<PhysicsSystemMaterial>;
 
@@ -32,4 +179,16 @@ struct PhysicsRigidBodyParams
 	std::shared_ptr<physx::PxGeometry> Geometry = nullptr;
 
 	PhysicsSystemMaterialPtr Material = nullptr;
+
+	PhysicsCollisionLayer Layer = PhysicsCollisionLayer::Default;
+
+	// Reports contacts with this body to the listener of either actor.
+	bool ReportContacts = false;
+
+	// Makes the body a trigger volume, which reports overlaps instead of colliding.
+	bool IsTrigger = false;
+
+	// Collides cylinder and cone custom geometries as a cooked convex hull instead. Much cheaper in
+	// narrowphase than the custom geometry callbacks, but the round surfaces become faceted.
+	bool UseConvexHull = false;
 };
@@ -0,0 +1,32 @@
+#include "Physics/PhysicsContext.h"
+#include "Physics/PhysicsSystem.h"
+
+PhysicsContext::PhysicsContext(mage::JobSystem& jobSystem) :
+	mDispatcher(jobSystem)
+{
+	mFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, mAllocator, mErrorCallback);
+	mage_check(mFoundation);
+	mFoundation->setReportAllocationNames(true);
+
+	mPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *mFoundation, physx::PxTolerancesScale());
+
+	mShapeCache = std::make_unique<PhysicsShapeCache>(*mPhysics);
+	mMeshCooker = std::make_unique<PhysicsMeshCooker>(*mPhysics, "Cache/Collision");
+}
+
+PhysicsContext::~PhysicsContext()
+{
+	mShapeCache.reset();
+	mMeshCooker.reset();
+	PX_RELEASE(mPhysics);
+	PX_RELEASE(mFoundation);
+}
+
+void PhysicsContext::Update(mage::Array<PhysicsSystem*> const& systems, f32 deltaTime)
+{
+	for (PhysicsSystem* system : systems)
+		system->BeginSimulation(deltaTime);
+
+	for (PhysicsSystem* system : systems)
+		system->EndSimulation();
+}
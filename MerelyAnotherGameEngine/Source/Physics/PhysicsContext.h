@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Physics/PhysicsAllocator.h"
+#include "Physics/PhysicsCpuDispatcher.h"
+#include "Physics/PhysicsMeshCooker.h"
+#include "Physics/PhysicsShapeCache.h"
+
+#include <PxPhysicsAPI.h>
+
+class PhysicsSystem;
+
+// The PhysX SDK objects which every scene in the process shares: foundation, physics, allocator,
+// the dispatcher running simulation tasks on the job system, and the shape and mesh caches. PhysX
+// allows a single foundation per process, so there must only be one context at a time; each
+// PhysicsSystem built on it only adds its own scene.
+class PhysicsContext : public NonCopyableClass
+{
+public:
+	PhysicsContext(mage::JobSystem& jobSystem);
+
+	~PhysicsContext();
+
+	// Steps the systems together: all of them start before any is waited for, so their tasks
+	// share the job system instead of running one scene after the other.
+	static void Update(mage::Array<PhysicsSystem*> const& systems, f32 deltaTime);
+
+	physx::PxPhysics& GetPhysics() const { return *mPhysics; }
+	PhysicsCpuDispatcher& GetDispatcher() { return mDispatcher; }
+	PhysicsShapeCache& GetShapeCache() { return *mShapeCache; }
+	PhysicsMeshCooker& GetMeshCooker() { return *mMeshCooker; }
+	PhysicsAllocator& GetAllocator() { return mAllocator; }
+	const PhysicsAllocator& GetAllocator() const { return mAllocator; }
+
+private:
+	PhysicsAllocator mAllocator;
+	physx::PxDefaultErrorCallback mErrorCallback;
+	physx::PxFoundation* mFoundation = nullptr;
+	physx::PxPhysics* mPhysics = nullptr;
+	PhysicsCpuDispatcher mDispatcher;
+
+	std::unique_ptr<PhysicsShapeCache> mShapeCache;
+	std::unique_ptr<PhysicsMeshCooker> mMeshCooker;
+};
@@ -0,0 +1,18 @@
+#include "Physics/PhysicsCpuDispatcher.h"
+
+#include <task/PxTask.h>
+
+void PhysicsCpuDispatcher::submitTask(physx::PxBaseTask& task)
+{
+	mJobSystem.Schedule([&task]()
+		{
+			task.run();
+			task.release();
+		});
+}
+
+uint32_t PhysicsCpuDispatcher::getWorkerCount() const
+{
+	// The thread waiting on the simulation helps execute tasks, so it counts as a worker.
+	return mJobSystem.GetThreadCount();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Core/JobSystem.h"
+
+#include <task/PxCpuDispatcher.h>
+
+// Runs PhysX simulation tasks as jobs on the engine's job system, instead of on private threads.
+class PhysicsCpuDispatcher : public physx::PxCpuDispatcher, public NonCopyableClass
+{
+public:
+	PhysicsCpuDispatcher(mage::JobSystem& jobSystem) : mJobSystem(jobSystem) {}
+
+	void submitTask(physx::PxBaseTask& task) override;
+
+	uint32_t getWorkerCount() const override;
+
+	mage::JobSystem& GetJobSystem() const { return mJobSystem; }
+
+private:
+	mage::JobSystem& mJobSystem;
+};
@@ -0,0 +1,106 @@
+#include "Physics/PhysicsEventBuffer.h"
+
+#include <PxActor.h>
+
+PhysicsEventBuffer::PhysicsEventBuffer()
+{
+	mContacts.Reserve(cInitialCapacity);
+	mTriggers.Reserve(cInitialCapacity);
+}
+
+void PhysicsEventBuffer::Dispatch()
+{
+	for (const ContactRecord& record : mContacts)
+	{
+		for (u32 i = 0; i < 2; ++i)
+		{
+			if (record.Listeners[i] == nullptr)
+				continue;
+
+			const PhysicsContactEvent event
+			{
+				.Type = record.Type,
+				.Other = record.Listeners[1 - i],
+				.Position = record.Position,
+				.Normal = i == 0 ? record.Normal : -record.Normal
+			};
+
+			record.Listeners[i]->OnPhysicsContact(event);
+		}
+	}
+
+	for (const TriggerRecord& record : mTriggers)
+	{
+		if (record.Trigger)
+			record.Trigger->OnPhysicsTrigger({ record.Type, record.Other, true });
+
+		if (record.Other)
+			record.Other->OnPhysicsTrigger({ record.Type, record.Trigger, false });
+	}
+
+	mContacts.Empty();
+	mTriggers.Empty();
+}
+
+void PhysicsEventBuffer::onContact(const physx::PxContactPairHeader& pairHeader, const physx::PxContactPair* pairs, physx::PxU32 pairCount)
+{
+	if (pairHeader.flags & (physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_0 | physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_1))
+		return;
+
+	PhysicsActorListener* listener0 = static_cast<PhysicsActorListener*>(pairHeader.actors[0]->userData);
+	PhysicsActorListener* listener1 = static_cast<PhysicsActorListener*>(pairHeader.actors[1]->userData);
+
+	if (listener0 == nullptr && listener1 == nullptr)
+		return;
+
+	for (physx::PxU32 i = 0; i < pairCount; ++i)
+	{
+		const physx::PxContactPair& pair = pairs[i];
+
+		ContactRecord record{ { listener0, listener1 } };
+
+		if (pair.events & physx::PxPairFlag::eNOTIFY_TOUCH_FOUND)
+			record.Type = PhysicsContactEventType::Begin;
+		else if (pair.events & physx::PxPairFlag::eNOTIFY_TOUCH_LOST)
+			record.Type = PhysicsContactEventType::End;
+		else
+			continue;
+
+		physx::PxContactPairPoint point;
+		if (pair.contactCount > 0 && pair.extractContacts(&point, 1) > 0)
+		{
+			record.Position = point.position;
+			record.Normal = point.normal;
+		}
+		else
+		{
+			record.Position = physx::PxVec3(physx::PxZero);
+			record.Normal = physx::PxVec3(physx::PxZero);
+		}
+
+		mContacts.Add(record);
+	}
+}
+
+void PhysicsEventBuffer::onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count)
+{
+	for (physx::PxU32 i = 0; i < count; ++i)
+	{
+		const physx::PxTriggerPair& pair = pairs[i];
+
+		if (pair.flags & (physx::PxTriggerPairFlag::eREMOVED_SHAPE_TRIGGER | physx::PxTriggerPairFlag::eREMOVED_SHAPE_OTHER))
+			continue;
+
+		PhysicsActorListener* trigger = static_cast<PhysicsActorListener*>(pair.triggerActor->userData);
+		PhysicsActorListener* other = static_cast<PhysicsActorListener*>(pair.otherActor->userData);
+
+		if (trigger == nullptr && other == nullptr)
+			continue;
+
+		const PhysicsTriggerEventType type = pair.status == physx::PxPairFlag::eNOTIFY_TOUCH_FOUND
+			? PhysicsTriggerEventType::Enter
+			: PhysicsTriggerEventType::Leave;
+
+		mTriggers.Add({ trigger, other, type });
+	}
+}
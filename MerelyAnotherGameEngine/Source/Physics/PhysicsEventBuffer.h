@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Physics/PhysicsCommon.h"
+
+#include <PxSimulationEventCallback.h>
+
+// Records contact and trigger reports while PhysX fetches results, to hand them to the listeners of
+// the actors involved in one pass afterwards. Its arrays keep their capacity between steps.
+class PhysicsEventBuffer : public physx::PxSimulationEventCallback, public NonCopyableClass
+{
+public:
+	PhysicsEventBuffer();
+
+	// Delivers the recorded events and clears them.
+	void Dispatch();
+
+	virtual void onContact(const physx::PxContactPairHeader& pairHeader, const physx::PxContactPair* pairs, physx::PxU32 pairCount) override;
+
+	virtual void onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count) override;
+
+	virtual void onConstraintBreak(physx::PxConstraintInfo* constraints, physx::PxU32 count) override {}
+
+	virtual void onWake(physx::PxActor** actors, physx::PxU32 count) override {}
+
+	virtual void onSleep(physx::PxActor** actors, physx::PxU32 count) override {}
+
+	virtual void onAdvance(const physx::PxRigidBody* const* bodyBuffer, const physx::PxTransform* poseBuffer, const physx::PxU32 count) override {}
+
+private:
+	static constexpr u32 cInitialCapacity = 256;
+
+	struct ContactRecord
+	{
+		PhysicsActorListener* Listeners[2];
+		PhysicsContactEventType Type;
+		physx::PxVec3 Position;
+		physx::PxVec3 Normal;
+	};
+
+	struct TriggerRecord
+	{
+		PhysicsActorListener* Trigger;
+		PhysicsActorListener* Other;
+		PhysicsTriggerEventType Type;
+	};
+
+	mage::Array<ContactRecord> mContacts;
+	mage::Array<TriggerRecord> mTriggers;
+};
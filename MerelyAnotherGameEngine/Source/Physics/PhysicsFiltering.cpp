@@ -0,0 +1,34 @@
+#include "Physics/PhysicsCommon.h"
+#include "Physics/PhysicsFiltering.h"
+
+physx::PxFilterFlags PhysicsFilterShader(
+	physx::PxFilterObjectAttributes attributes0,
+	physx::PxFilterData filterData0,
+	physx::PxFilterObjectAttributes attributes1,
+	physx::PxFilterData filterData1,
+	physx::PxPairFlags& pairFlags,
+	const void* constantBlock,
+	physx::PxU32 constantBlockSize)
+{
+	const PhysicsCollisionMatrix& collisionMatrix = *static_cast<const PhysicsCollisionMatrix*>(constantBlock);
+
+	if (!collisionMatrix.Interacts(filterData0.word0, filterData1.word0))
+		return physx::PxFilterFlag::eKILL;
+
+	if (physx::PxFilterObjectIsTrigger(attributes0) || physx::PxFilterObjectIsTrigger(attributes1))
+	{
+		pairFlags = physx::PxPairFlag::eTRIGGER_DEFAULT;
+		return physx::PxFilterFlag::eDEFAULT;
+	}
+
+	pairFlags = physx::PxPairFlag::eCONTACT_DEFAULT;
+
+	if ((filterData0.word1 | filterData1.word1) & cPhysicsFilterReportContacts)
+	{
+		pairFlags |= physx::PxPairFlag::eNOTIFY_TOUCH_FOUND;
+		pairFlags |= physx::PxPairFlag::eNOTIFY_TOUCH_LOST;
+		pairFlags |= physx::PxPairFlag::eNOTIFY_CONTACT_POINTS;
+	}
+
+	return physx::PxFilterFlag::eDEFAULT;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <PxFiltering.h>
+
+// PxFilterData::word0 on simulation shapes holds the PhysicsCollisionLayer, word1 these bits.
+constexpr u32 cPhysicsFilterReportContacts = 1 << 0;
+
+// Drops pairs whose layers do not interact according to the PhysicsCollisionMatrix passed as the
+// filter shader data, before they reach narrowphase. Remaining pairs collide as usual, with contact
+// reports where either shape asks for them.
+physx::PxFilterFlags PhysicsFilterShader(
+	physx::PxFilterObjectAttributes attributes0,
+	physx::PxFilterData filterData0,
+	physx::PxFilterObjectAttributes attributes1,
+	physx::PxFilterData filterData1,
+	physx::PxPairFlags& pairFlags,
+	const void* constantBlock,
+	physx::PxU32 constantBlockSize);
@@ -0,0 +1,218 @@
+#include "Physics/PhysicsMeshCooker.h"
+
+#include "Assets/StaticMesh.h"
+
+#include <PxPhysicsAPI.h>
+
+#include <filesystem>
+#include <thread>
+
+namespace
+{
+	// Bump when the cooking params change, so that stale cache files are not picked up.
+	constexpr u32 cCookingVersion = 1;
+}
+
+PhysicsMeshCooker::PhysicsMeshCooker(physx::PxPhysics& physics, mage::StringView cacheDirectory) :
+	mPhysics(physics),
+	mCacheDirectory(cacheDirectory.GetCString())
+{
+	std::error_code error;
+	std::filesystem::create_directories(mCacheDirectory, error);
+}
+
+std::shared_ptr<physx::PxGeometry> PhysicsMeshCooker::GetTriangleMesh(const StaticMesh& mesh)
+{
+	physx::PxTriangleMesh* triangleMesh = static_cast<physx::PxTriangleMesh*>(LoadOrCook(MeshType::Triangle, GetPoints(mesh), GetIndices(mesh)));
+	if (triangleMesh == nullptr)
+		return nullptr;
+
+	// Shapes hold their own reference to the mesh, so it only has to live as long as the geometry.
+	return std::shared_ptr<physx::PxTriangleMeshGeometry>(new physx::PxTriangleMeshGeometry(triangleMesh), [](physx::PxTriangleMeshGeometry* geometry)
+		{
+			geometry->triangleMesh->release();
+			delete geometry;
+		});
+}
+
+std::shared_ptr<physx::PxGeometry> PhysicsMeshCooker::GetConvexMesh(const StaticMesh& mesh)
+{
+	physx::PxConvexMesh* convexMesh = static_cast<physx::PxConvexMesh*>(LoadOrCook(MeshType::Convex, GetPoints(mesh), {}));
+	if (convexMesh == nullptr)
+		return nullptr;
+
+	return std::shared_ptr<physx::PxConvexMeshGeometry>(new physx::PxConvexMeshGeometry(convexMesh), [](physx::PxConvexMeshGeometry* geometry)
+		{
+			geometry->convexMesh->release();
+			delete geometry;
+		});
+}
+
+physx::PxBase* PhysicsMeshCooker::LoadOrCook(MeshType type, const mage::Array<physx::PxVec3>& points, const mage::Array<u32>& indices)
+{
+	const std::string cachePath = GetCachePath(type, points, indices);
+
+	std::error_code error;
+	if (std::filesystem::is_regular_file(cachePath, error))
+	{
+		mage::Array<u8> data = mage::ReadFile(cachePath.c_str());
+		if (physx::PxBase* mesh = CreateMesh(type, data))
+		{
+			++mLoadedCount;
+			return mesh;
+		}
+
+		// Truncated, or written by a PhysX that reads it differently. Cook it again in its place.
+		std::filesystem::remove(cachePath, error);
+	}
+
+	mage::Array<u8> data;
+	if (!Cook(type, points, indices, data))
+		return nullptr;
+
+	++mCookedCount;
+
+	if (!WriteCache(cachePath, data))
+		++mFailedWriteCount;
+
+	return CreateMesh(type, data);
+}
+
+physx::PxBase* PhysicsMeshCooker::CreateMesh(MeshType type, mage::Array<u8>& data) const
+{
+	if (data.IsEmpty())
+		return nullptr;
+
+	physx::PxDefaultMemoryInputData input(data.GetData(), data.GetSize());
+
+	switch (type)
+	{
+		case MeshType::Triangle:
+			return mPhysics.createTriangleMesh(input);
+
+		case MeshType::Convex:
+			return mPhysics.createConvexMesh(input);
+	}
+
+	return nullptr;
+}
+
+bool PhysicsMeshCooker::WriteCache(const std::string& cachePath, const mage::Array<u8>& data) const
+{
+	// Write to a temporary file first, so that an interrupted run cannot leave a truncated entry. It
+	// is named after the thread, as another thread may be cooking the same mesh.
+	const std::string temporaryPath = cachePath + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+
+	std::error_code error;
+
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(data.GetData()), data.GetSize());
+		file.close();
+
+		if (!file)
+		{
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(temporaryPath, cachePath, error);
+	if (error)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	return true;
+}
+
+bool PhysicsMeshCooker::Cook(MeshType type, const mage::Array<physx::PxVec3>& points, const mage::Array<u32>& indices, mage::Array<u8>& outData) const
+{
+	const physx::PxCookingParams params(mPhysics.getTolerancesScale());
+	physx::PxDefaultMemoryOutputStream output;
+
+	bool result = false;
+
+	switch (type)
+	{
+		case MeshType::Triangle:
+		{
+			physx::PxTriangleMeshDesc desc;
+			desc.points.count = points.GetSize();
+			desc.points.stride = sizeof(physx::PxVec3);
+			desc.points.data = points.GetData();
+			desc.triangles.count = indices.GetSize() / 3;
+			desc.triangles.stride = 3 * sizeof(u32);
+			desc.triangles.data = indices.GetData();
+
+			result = PxCookTriangleMesh(params, desc, output);
+			break;
+		}
+
+		case MeshType::Convex:
+		{
+			physx::PxConvexMeshDesc desc;
+			desc.points.count = points.GetSize();
+			desc.points.stride = sizeof(physx::PxVec3);
+			desc.points.data = points.GetData();
+			desc.flags = physx::PxConvexFlag::eCOMPUTE_CONVEX;
+
+			result = PxCookConvexMesh(params, desc, output);
+			break;
+		}
+	}
+
+	if (result)
+	{
+		outData.ResizeUninitialized(output.getSize());
+		std::memcpy(outData.GetData(), output.getData(), output.getSize());
+	}
+
+	return result;
+}
+
+std::string PhysicsMeshCooker::GetCachePath(MeshType type, const mage::Array<physx::PxVec3>& points, const mage::Array<u32>& indices) const
+{
+	const u32 header[] = { cCookingVersion, PX_PHYSICS_VERSION, u32(type) };
+
+	// Cooking bakes the tolerances into the mesh, so a differently scaled PxPhysics needs its own entry.
+	const physx::PxTolerancesScale& scale = mPhysics.getTolerancesScale();
+	const f32 tolerances[] = { scale.length, scale.speed };
+
+	u64 hash = mage::HashBytes(header, sizeof(header));
+	hash = mage::HashBytes(tolerances, sizeof(tolerances), hash);
+	hash = mage::HashBytes(points.GetData(), u64(points.GetSize()) * sizeof(physx::PxVec3), hash);
+	hash = mage::HashBytes(indices.GetData(), u64(indices.GetSize()) * sizeof(u32), hash);
+
+	char fileName[32];
+	std::snprintf(fileName, sizeof(fileName), "%016llx.%s", static_cast<unsigned long long>(hash), type == MeshType::Triangle ? "tri" : "cvx");
+
+	return (std::filesystem::path(mCacheDirectory) / fileName).string();
+}
+
+mage::Array<physx::PxVec3> PhysicsMeshCooker::GetPoints(const StaticMesh& mesh)
+{
+	mage::Array<physx::PxVec3> points;
+	points.Reserve(mesh.GetVertices().GetSize());
+
+	for (const StaticMesh::Vertex& vertex : mesh.GetVertices())
+		points.Add(physx::PxVec3(vertex.Position.x, vertex.Position.y, vertex.Position.z));
+
+	return points;
+}
+
+mage::Array<u32> PhysicsMeshCooker::GetIndices(const StaticMesh& mesh)
+{
+	mage::Array<u32> indices;
+	indices.Reserve(3 * mesh.GetFaces().GetSize());
+
+	for (const StaticMesh::Triangle& face : mesh.GetFaces())
+	{
+		indices.Add(face.Index[0]);
+		indices.Add(face.Index[1]);
+		indices.Add(face.Index[2]);
+	}
+
+	return indices;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Physics/PhysicsCommon.h"
+
+#include <atomic>
+#include <string>
+
+class StaticMesh;
+
+namespace physx
+{
+	class PxBase;
+	class PxPhysics;
+}
+
+// Cooks PhysX collision meshes from StaticMesh data. Cooked meshes are written to the cache
+// directory under a hash of their input, so later runs load them instead of cooking again. The
+// returned geometries release their mesh when destroyed, so they must not outlive the PxPhysics.
+// Meshes may be requested from several threads; two threads asking for the same new mesh may both
+// cook it. Cache entries PhysX cannot read are cooked again and replaced, and a cache that cannot be
+// written only costs the next run its cooking time.
+class PhysicsMeshCooker : public NonCopyableClass
+{
+public:
+	PhysicsMeshCooker(physx::PxPhysics& physics, mage::StringView cacheDirectory);
+
+	// Exact collision with the mesh's faces. Triangle meshes can only be used by static and
+	// kinematic bodies. Null when the mesh cannot be cooked, as when it has no usable faces.
+	std::shared_ptr<physx::PxGeometry> GetTriangleMesh(const StaticMesh& mesh);
+
+	// The convex hull of the mesh's vertices, reduced to at most 255 vertices by PhysX. Null when
+	// the mesh cannot be cooked, as when its vertices do not span a volume.
+	std::shared_ptr<physx::PxGeometry> GetConvexMesh(const StaticMesh& mesh);
+
+	u32 GetCookedCount() const { return mCookedCount.load(); }
+	u32 GetLoadedCount() const { return mLoadedCount.load(); }
+	u32 GetFailedWriteCount() const { return mFailedWriteCount.load(); }
+
+private:
+	enum class MeshType : u8
+	{
+		Triangle,
+		Convex
+	};
+
+	// Creates the mesh from the cache, or cooks it when the cache has no readable entry. Null when
+	// cooking fails.
+	physx::PxBase* LoadOrCook(MeshType type, const mage::Array<physx::PxVec3>& points, const mage::Array<u32>& indices);
+
+	// Null when PhysX cannot read the data.
+	physx::PxBase* CreateMesh(MeshType type, mage::Array<u8>& data) const;
+
+	bool WriteCache(const std::string& cachePath, const mage::Array<u8>& data) const;
+
+	bool Cook(MeshType type, const mage::Array<physx::PxVec3>& points, const mage::Array<u32>& indices, mage::Array<u8>& outData) const;
+
+	std::string GetCachePath(MeshType type, const mage::Array<physx::PxVec3>& points, const mage::Array<u32>& indices) const;
+
+	static mage::Array<physx::PxVec3> GetPoints(const StaticMesh& mesh);
+	static mage::Array<u32> GetIndices(const StaticMesh& mesh);
+
+	physx::PxPhysics& mPhysics;
+
+	std::string mCacheDirectory;
+
+	std::atomic<u32> mCookedCount = 0;
+	std::atomic<u32> mLoadedCount = 0;
+	std::atomic<u32> mFailedWriteCount = 0;
+};
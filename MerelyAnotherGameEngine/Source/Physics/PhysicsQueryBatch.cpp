@@ -0,0 +1,136 @@
+#include "Physics/PhysicsQueryBatch.h"
+
+#include "Core/JobSystem.h"
+
+#include <PxPhysicsAPI.h>
+
+namespace
+{
+	class IgnoreActorFilter : public physx::PxQueryFilterCallback
+	{
+	public:
+		IgnoreActorFilter(physx::PxRigidActor const* ignoredActor) : mIgnoredActor(ignoredActor) {}
+
+		virtual physx::PxQueryHitType::Enum preFilter(const physx::PxFilterData& filterData, const physx::PxShape* shape, const physx::PxRigidActor* actor, physx::PxHitFlags& queryFlags) override
+		{
+			return actor == mIgnoredActor ? physx::PxQueryHitType::eNONE : physx::PxQueryHitType::eBLOCK;
+		}
+
+		virtual physx::PxQueryHitType::Enum postFilter(const physx::PxFilterData& filterData, const physx::PxQueryHit& hit, const physx::PxShape* shape, const physx::PxRigidActor* actor) override
+		{
+			return physx::PxQueryHitType::eBLOCK;
+		}
+
+	private:
+		physx::PxRigidActor const* mIgnoredActor;
+	};
+
+	physx::PxQueryFilterData MakeFilterData(physx::PxRigidActor const* ignoredActor, physx::PxQueryFlags extraFlags = {})
+	{
+		physx::PxQueryFlags flags = physx::PxQueryFlag::eSTATIC | physx::PxQueryFlag::eDYNAMIC | extraFlags;
+		if (ignoredActor)
+			flags |= physx::PxQueryFlag::ePREFILTER;
+
+		return physx::PxQueryFilterData(flags);
+	}
+
+	template<typename Query, typename Function>
+	void RunQueries(const mage::Array<Query>& queries, mage::Array<PhysicsQueryHit>& hits, mage::JobSystem& jobSystem, u32 parallelBatchSize, const Function& function)
+	{
+		hits.Empty();
+		hits.ResizeDefault(queries.GetSize());
+
+		auto runRange = [&queries, &hits, &function](u32 begin, u32 end)
+			{
+				for (u32 i = begin; i < end; ++i)
+					hits[i] = function(queries[i]);
+			};
+
+		if (queries.GetSize() > parallelBatchSize)
+			jobSystem.ParallelForRange(queries.GetSize(), parallelBatchSize, runRange);
+		else
+			runRange(0, queries.GetSize());
+	}
+}
+
+PhysicsActorListener* PhysicsQueryHit::GetListener() const
+{
+	// Removing an actor clears its user data right away, before the actor is released.
+	return Actor ? static_cast<PhysicsActorListener*>(Actor->userData) : nullptr;
+}
+
+u32 PhysicsQueryBatch::AddRaycast(const PhysicsRaycast& raycast)
+{
+	std::lock_guard lock(mMutex);
+	return mRaycasts.Add(raycast);
+}
+
+u32 PhysicsQueryBatch::AddSweep(const PhysicsSweep& sweep)
+{
+	std::lock_guard lock(mMutex);
+	return mSweeps.Add(sweep);
+}
+
+u32 PhysicsQueryBatch::AddOverlap(const PhysicsOverlap& overlap)
+{
+	std::lock_guard lock(mMutex);
+	return mOverlaps.Add(overlap);
+}
+
+void PhysicsQueryBatch::Execute(const physx::PxScene& scene, mage::JobSystem& jobSystem)
+{
+	std::lock_guard lock(mMutex);
+
+	RunQueries(mRaycasts, mRaycastHits, jobSystem, cParallelBatchSize, [&scene](const PhysicsRaycast& raycast)
+		{
+			IgnoreActorFilter filter(raycast.IgnoredActor);
+			physx::PxRaycastBuffer buffer;
+
+			PhysicsQueryHit hit;
+			if (scene.raycast(raycast.Origin, raycast.Direction, raycast.MaxDistance, buffer, physx::PxHitFlag::eDEFAULT, MakeFilterData(raycast.IgnoredActor), &filter) && buffer.hasBlock)
+				hit = { buffer.block.actor, buffer.block.position, buffer.block.normal, buffer.block.distance };
+
+			return hit;
+		});
+
+	RunQueries(mSweeps, mSweepHits, jobSystem, cParallelBatchSize, [&scene](const PhysicsSweep& sweep)
+		{
+			IgnoreActorFilter filter(sweep.IgnoredActor);
+			physx::PxSweepBuffer buffer;
+
+			PhysicsQueryHit hit;
+			if (scene.sweep(sweep.Geometry.any(), sweep.Pose, sweep.Direction, sweep.MaxDistance, buffer, physx::PxHitFlag::eDEFAULT, MakeFilterData(sweep.IgnoredActor), &filter) && buffer.hasBlock)
+				hit = { buffer.block.actor, buffer.block.position, buffer.block.normal, buffer.block.distance };
+
+			return hit;
+		});
+
+	RunQueries(mOverlaps, mOverlapHits, jobSystem, cParallelBatchSize, [&scene](const PhysicsOverlap& overlap)
+		{
+			IgnoreActorFilter filter(overlap.IgnoredActor);
+			physx::PxOverlapBuffer buffer;
+
+			PhysicsQueryHit hit;
+			if (scene.overlap(overlap.Geometry.any(), overlap.Pose, buffer, MakeFilterData(overlap.IgnoredActor, physx::PxQueryFlag::eANY_HIT), &filter) && buffer.hasBlock)
+				hit.Actor = buffer.block.actor;
+
+			return hit;
+		});
+
+	mRaycasts.Empty();
+	mSweeps.Empty();
+	mOverlaps.Empty();
+
+	mAreHitsDiscarded = false;
+}
+
+void PhysicsQueryBatch::DiscardHits()
+{
+	std::lock_guard lock(mMutex);
+
+	mRaycastHits.Empty();
+	mSweepHits.Empty();
+	mOverlapHits.Empty();
+
+	mAreHitsDiscarded = true;
+}
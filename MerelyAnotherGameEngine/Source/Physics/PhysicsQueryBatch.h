@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Physics/PhysicsCommon.h"
+
+#include <geometry/PxGeometryHelpers.h>
+
+#include <mutex>
+
+namespace mage
+{
+	class JobSystem;
+}
+
+namespace physx
+{
+	class PxRigidActor;
+	class PxScene;
+}
+
+struct PhysicsRaycast
+{
+	physx::PxVec3 Origin;
+	physx::PxVec3 Direction;
+	f32 MaxDistance;
+
+	// Skipped by the query, typically the actor of whoever is asking.
+	physx::PxRigidActor const* IgnoredActor = nullptr;
+};
+
+struct PhysicsSweep
+{
+	physx::PxGeometryHolder Geometry;
+	physx::PxTransform Pose;
+	physx::PxVec3 Direction;
+	f32 MaxDistance;
+
+	physx::PxRigidActor const* IgnoredActor = nullptr;
+};
+
+struct PhysicsOverlap
+{
+	physx::PxGeometryHolder Geometry;
+	physx::PxTransform Pose;
+
+	physx::PxRigidActor const* IgnoredActor = nullptr;
+};
+
+// Closest hit of a raycast or sweep, or any overlapping actor for overlaps. The actor is only valid
+// until PhysicsSystem releases removed actors with its next batch of actor changes, which discards
+// the hits.
+struct PhysicsQueryHit
+{
+	physx::PxRigidActor* Actor = nullptr;
+	physx::PxVec3 Position = physx::PxVec3(physx::PxZero);
+	physx::PxVec3 Normal = physx::PxVec3(physx::PxZero);
+	f32 Distance = 0.0f;
+
+	bool HasHit() const { return Actor != nullptr; }
+
+	// Null for actors without a listener, and for actors removed since the query ran.
+	PhysicsActorListener* GetListener() const;
+};
+
+// Collects scene queries and runs them together. Queries can be added from several threads at once,
+// and are answered in arrays indexed by the values returned when adding them.
+class PhysicsQueryBatch : public NonCopyableClass
+{
+public:
+	u32 AddRaycast(const PhysicsRaycast& raycast);
+	u32 AddSweep(const PhysicsSweep& sweep);
+	u32 AddOverlap(const PhysicsOverlap& overlap);
+
+	// Answers all added queries, spreading large batches over the job system. Results of the previous
+	// execution are replaced and the batch is emptied.
+	void Execute(const physx::PxScene& scene, mage::JobSystem& jobSystem);
+
+	const mage::Array<PhysicsQueryHit>& GetRaycastHits() const { mage_check(!mAreHitsDiscarded); return mRaycastHits; }
+	const mage::Array<PhysicsQueryHit>& GetSweepHits() const { mage_check(!mAreHitsDiscarded); return mSweepHits; }
+	const mage::Array<PhysicsQueryHit>& GetOverlapHits() const { mage_check(!mAreHitsDiscarded); return mOverlapHits; }
+
+	// Drops the hits of the last execution, whose actors are about to be released. Reading hits is an
+	// error until the next execution.
+	void DiscardHits();
+
+private:
+	static constexpr u32 cParallelBatchSize = 32;
+
+	std::mutex mMutex;
+
+	mage::Array<PhysicsRaycast> mRaycasts;
+	mage::Array<PhysicsSweep> mSweeps;
+	mage::Array<PhysicsOverlap> mOverlaps;
+
+	mage::Array<PhysicsQueryHit> mRaycastHits;
+	mage::Array<PhysicsQueryHit> mSweepHits;
+	mage::Array<PhysicsQueryHit> mOverlapHits;
+
+	bool mAreHitsDiscarded = false;
+};
@@ -0,0 +1,208 @@
+#include "Physics/PhysicsFiltering.h"
+#include "Physics/PhysicsShapeCache.h"
+#include "Physics/PhysicsSystem.h"
+
+#include <extensions/PxCustomGeometryExt.h>
+
+namespace
+{
+	// Same as the radial vertex count of the cylinder and cone render meshes, so that collision
+	// matches what is drawn.
+	constexpr u32 cHullRadialVertexCount = 48;
+}
+
+PhysicsShapeCache::~PhysicsShapeCache()
+{
+	for (auto& [key, entry] : mShapes)
+		entry.Shape->release();
+
+	// After the shapes, which reference the meshes.
+	for (auto& [key, convexMesh] : mConvexMeshes)
+		convexMesh->release();
+}
+
+physx::PxShape& PhysicsShapeCache::GetShape(const PhysicsRigidBodyParams& params)
+{
+	const Key key = MakeKey(params);
+
+	std::lock_guard lock(mMutex);
+
+	auto it = mShapes.find(key);
+	if (it != mShapes.end())
+		return *it->second.Shape;
+
+	physx::PxMaterial* material = params.Material.get() ? &params.Material->Get() : nullptr;
+
+	const physx::PxShapeFlags shapeFlags = params.IsTrigger
+		? physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eTRIGGER_SHAPE
+		: physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE;
+
+	physx::PxConvexMesh* convexHull = params.UseConvexHull ? GetConvexHull(params) : nullptr;
+	const physx::PxConvexMeshGeometry convexHullGeometry = convexHull ? physx::PxConvexMeshGeometry(convexHull) : physx::PxConvexMeshGeometry();
+	const physx::PxGeometry& geometry = convexHull ? static_cast<const physx::PxGeometry&>(convexHullGeometry) : *params.Geometry;
+
+	physx::PxShape* shape = mPhysics.createShape(geometry, &material, 1, false, shapeFlags);
+	mage_check(shape);
+
+	physx::PxFilterData filterData;
+	filterData.word0 = u32(params.Layer);
+	filterData.word1 = params.ReportContacts ? cPhysicsFilterReportContacts : 0;
+	shape->setSimulationFilterData(filterData);
+
+	mShapes.emplace(key, Entry{ shape, params.Geometry, params.CustomGeometryCallbacks, params.Material });
+
+	return *shape;
+}
+
+u32 PhysicsShapeCache::GetShapeCount() const
+{
+	std::lock_guard lock(mMutex);
+	return u32(mShapes.size());
+}
+
+u32 PhysicsShapeCache::GetConvexMeshCount() const
+{
+	std::lock_guard lock(mMutex);
+	return u32(mConvexMeshes.size());
+}
+
+u64 PhysicsShapeCache::KeyHash::operator()(const Key& key) const
+{
+	u64 seed = 0;
+	mage::HashCombine(seed, key.GeometryType, key.Dimensions[0], key.Dimensions[1], key.Dimensions[2], key.GeometryIdentity, key.Material, u32(key.Layer), key.ReportContacts, key.IsTrigger, key.UseConvexHull);
+	return seed;
+}
+
+u64 PhysicsShapeCache::HullKeyHash::operator()(const HullKey& key) const
+{
+	u64 seed = 0;
+	mage::HashCombine(seed, key.IsCone, key.Height, key.Radius, key.Axis);
+	return seed;
+}
+
+PhysicsShapeCache::Key PhysicsShapeCache::MakeKey(const PhysicsRigidBodyParams& params)
+{
+	mage_check(params.Geometry);
+	const physx::PxGeometry& geometry = *params.Geometry;
+
+	Key key{};
+	key.GeometryType = u32(geometry.getType());
+	key.Material = params.Material.get() ? &params.Material->Get() : nullptr;
+	key.Layer = params.Layer;
+	key.ReportContacts = params.ReportContacts;
+	key.IsTrigger = params.IsTrigger;
+	key.UseConvexHull = params.UseConvexHull;
+
+	switch (geometry.getType())
+	{
+		case physx::PxGeometryType::eSPHERE:
+		{
+			key.Dimensions[0] = static_cast<const physx::PxSphereGeometry&>(geometry).radius;
+			break;
+		}
+
+		case physx::PxGeometryType::eBOX:
+		{
+			const physx::PxVec3& halfExtents = static_cast<const physx::PxBoxGeometry&>(geometry).halfExtents;
+			key.Dimensions[0] = halfExtents.x;
+			key.Dimensions[1] = halfExtents.y;
+			key.Dimensions[2] = halfExtents.z;
+			break;
+		}
+
+		case physx::PxGeometryType::eCAPSULE:
+		{
+			const physx::PxCapsuleGeometry& capsule = static_cast<const physx::PxCapsuleGeometry&>(geometry);
+			key.Dimensions[0] = capsule.radius;
+			key.Dimensions[1] = capsule.halfHeight;
+			break;
+		}
+
+		case physx::PxGeometryType::ePLANE:
+		{
+			break;
+		}
+
+		case physx::PxGeometryType::eCUSTOM:
+		{
+			key.GeometryIdentity = static_cast<const physx::PxCustomGeometry&>(geometry).callbacks;
+			break;
+		}
+
+		default:
+		{
+			key.GeometryIdentity = &geometry;
+			break;
+		}
+	}
+
+	return key;
+}
+
+physx::PxConvexMesh* PhysicsShapeCache::GetConvexHull(const PhysicsRigidBodyParams& params)
+{
+	HullKey key{};
+
+	if (auto* cylinder = dynamic_cast<physx::PxCustomGeometryExt::CylinderCallbacks*>(params.CustomGeometryCallbacks.get()))
+		key = { false, cylinder->getHeight(), cylinder->getRadius(), cylinder->getAxis() };
+	else if (auto* cone = dynamic_cast<physx::PxCustomGeometryExt::ConeCallbacks*>(params.CustomGeometryCallbacks.get()))
+		key = { true, cone->getHeight(), cone->getRadius(), cone->getAxis() };
+	else
+		return nullptr;
+
+	auto it = mConvexMeshes.find(key);
+	if (it != mConvexMeshes.end())
+		return it->second;
+
+	const mage::Array<physx::PxVec3> points = MakeHullPoints(key);
+
+	physx::PxConvexMeshDesc desc;
+	desc.points.count = points.GetSize();
+	desc.points.stride = sizeof(physx::PxVec3);
+	desc.points.data = points.GetData();
+	desc.flags = physx::PxConvexFlag::eCOMPUTE_CONVEX;
+
+	const physx::PxCookingParams cookingParams(mPhysics.getTolerancesScale());
+	physx::PxConvexMesh* convexMesh = PxCreateConvexMesh(cookingParams, desc, mPhysics.getPhysicsInsertionCallback());
+	mage_check(convexMesh);
+
+	mConvexMeshes.emplace(key, convexMesh);
+
+	return convexMesh;
+}
+
+mage::Array<physx::PxVec3> PhysicsShapeCache::MakeHullPoints(const HullKey& key)
+{
+	// Centered on the origin along the axis, like the custom geometries: a cone has its base at the
+	// negative end and its apex at the positive end.
+	const f32 halfHeight = 0.5f * key.Height;
+
+	auto makePoint = [&key](f32 alongAxis, f32 u, f32 v)
+		{
+			physx::PxVec3 point;
+			point[key.Axis] = alongAxis;
+			point[(key.Axis + 1) % 3] = u;
+			point[(key.Axis + 2) % 3] = v;
+			return point;
+		};
+
+	mage::Array<physx::PxVec3> points;
+	points.Reserve(2 * cHullRadialVertexCount);
+
+	for (u32 i = 0; i < cHullRadialVertexCount; ++i)
+	{
+		const f32 angle = glm::radians(360.0f * f32(i) / f32(cHullRadialVertexCount));
+		const f32 u = key.Radius * glm::cos(angle);
+		const f32 v = key.Radius * glm::sin(angle);
+
+		points.Add(makePoint(-halfHeight, u, v));
+
+		if (!key.IsCone)
+			points.Add(makePoint(halfHeight, u, v));
+	}
+
+	if (key.IsCone)
+		points.Add(makePoint(halfHeight, 0.0f, 0.0f));
+
+	return points;
+}
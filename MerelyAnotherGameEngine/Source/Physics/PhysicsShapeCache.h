@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Physics/PhysicsCommon.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace physx
+{
+	class PxConvexMesh;
+	class PxMaterial;
+	class PxPhysics;
+	class PxShape;
+}
+
+// Hands out one non-exclusive shape per distinct geometry and material, so that identical bodies
+// share a shape. Simple geometries are matched by value, others by the object that defines them.
+// Also cooks the convex hulls which stand in for cylinders and cones, once per distinct size.
+// Shared by every scene of a PhysicsContext, so it can be used from several threads.
+class PhysicsShapeCache : public NonCopyableClass
+{
+public:
+	PhysicsShapeCache(physx::PxPhysics& physics) : mPhysics(physics) {}
+
+	~PhysicsShapeCache();
+
+	// The cache keeps its own reference, so the shape stays valid until the cache is destroyed.
+	physx::PxShape& GetShape(const PhysicsRigidBodyParams& params);
+
+	u32 GetShapeCount() const;
+	u32 GetConvexMeshCount() const;
+
+private:
+	struct Key
+	{
+		u32 GeometryType;
+		f32 Dimensions[3];
+		void const* GeometryIdentity;
+		physx::PxMaterial const* Material;
+		PhysicsCollisionLayer Layer;
+		bool ReportContacts;
+		bool IsTrigger;
+		bool UseConvexHull;
+
+		bool operator==(const Key& other) const = default;
+	};
+
+	struct KeyHash
+	{
+		u64 operator()(const Key& key) const;
+	};
+
+	struct HullKey
+	{
+		bool IsCone;
+		f32 Height;
+		f32 Radius;
+		i32 Axis;
+
+		bool operator==(const HullKey& other) const = default;
+	};
+
+	struct HullKeyHash
+	{
+		u64 operator()(const HullKey& key) const;
+	};
+
+	struct Entry
+	{
+		physx::PxShape* Shape;
+
+		// Keep alive what the key points at, so that it cannot be reused by an unrelated geometry.
+		std::shared_ptr<physx::PxGeometry> Geometry;
+		std::shared_ptr<physx::PxCustomGeometry::Callbacks> CustomGeometryCallbacks;
+		PhysicsSystemMaterialPtr Material;
+	};
+
+	static Key MakeKey(const PhysicsRigidBodyParams& params);
+
+	// Null when the body's custom geometry is neither a cylinder nor a cone.
+	physx::PxConvexMesh* GetConvexHull(const PhysicsRigidBodyParams& params);
+
+	static mage::Array<physx::PxVec3> MakeHullPoints(const HullKey& key);
+
+	physx::PxPhysics& mPhysics;
+
+	mutable std::mutex mMutex;
+
+	std::unordered_map<Key, Entry, KeyHash> mShapes;
+	std::unordered_map<HullKey, physx::PxConvexMesh*, HullKeyHash> mConvexMeshes;
+};
@@ -1,50 +1,192 @@
+#include "Physics/PhysicsFiltering.h"
 #include "Physics/PhysicsSystem.h"
 
-PhysicsSystem::PhysicsSystem()
+PhysicsSystem::PhysicsSystem(PhysicsContext& context, const PhysicsSystemSettings& settings) :
+	mContext(context),
+	mPhysics(context.GetPhysics())
 {
-	mFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, mAllocator, mErrorCallback);
+	CreateScene(settings);
+}
+
+PhysicsSystem::PhysicsSystem(mage::JobSystem& jobSystem, const PhysicsSystemSettings& settings) :
+	PhysicsSystem(std::make_unique<PhysicsContext>(jobSystem), settings)
+{
+}
 
-	mPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *mFoundation, physx::PxTolerancesScale());
+PhysicsSystem::PhysicsSystem(std::unique_ptr<PhysicsContext>&& ownedContext, const PhysicsSystemSettings& settings) :
+	mOwnedContext(std::move(ownedContext)),
+	mContext(*mOwnedContext),
+	mPhysics(mContext.GetPhysics())
+{
+	CreateScene(settings);
+}
 
-	physx::PxSceneDesc sceneDesc(mPhysics->getTolerancesScale());
+void PhysicsSystem::CreateScene(const PhysicsSystemSettings& settings)
+{
+	physx::PxSceneDesc sceneDesc(mPhysics.getTolerancesScale());
 	sceneDesc.gravity = physx::PxVec3(0.0f, 0.0f, -9.81f);
-	mDispatcher = physx::PxDefaultCpuDispatcherCreate(2);
-	sceneDesc.cpuDispatcher = mDispatcher;
-	sceneDesc.filterShader = physx::PxDefaultSimulationFilterShader;
-	mScene = mPhysics->createScene(sceneDesc);
+	sceneDesc.cpuDispatcher = &mContext.GetDispatcher();
+	const PhysicsCollisionMatrix collisionMatrix;
+	sceneDesc.filterShader = PhysicsFilterShader;
+	sceneDesc.filterShaderData = &collisionMatrix;
+	sceneDesc.filterShaderDataSize = sizeof(collisionMatrix);
+	sceneDesc.simulationEventCallback = &mEventBuffer;
+	sceneDesc.flags |= physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS;
+	if (!settings.EnablePcm)
+		sceneDesc.flags.clear(physx::PxSceneFlag::eENABLE_PCM);
+	sceneDesc.solverType = settings.Solver == PhysicsSolverType::TGS ? physx::PxSolverType::eTGS : physx::PxSolverType::ePGS;
+
+	switch (settings.BroadPhase)
+	{
+		case PhysicsBroadPhaseType::SAP: sceneDesc.broadPhaseType = physx::PxBroadPhaseType::eSAP; break;
+		case PhysicsBroadPhaseType::MBP: sceneDesc.broadPhaseType = physx::PxBroadPhaseType::eMBP; break;
+		case PhysicsBroadPhaseType::ABP: sceneDesc.broadPhaseType = physx::PxBroadPhaseType::eABP; break;
+		case PhysicsBroadPhaseType::PABP: sceneDesc.broadPhaseType = physx::PxBroadPhaseType::ePABP; break;
+	}
+
+	mScene = mPhysics.createScene(sceneDesc);
+
+	if (settings.BroadPhase == PhysicsBroadPhaseType::MBP)
+	{
+		mage::Array<physx::PxBounds3> regions;
+		regions.ResizeUninitialized(settings.BroadPhaseRegionsPerAxis * settings.BroadPhaseRegionsPerAxis);
+
+		const u32 regionCount = physx::PxBroadPhaseExt::createRegionsFromWorldBounds(regions.GetData(), settings.WorldBounds, settings.BroadPhaseRegionsPerAxis, 2);
+
+		for (u32 i = 0; i < regionCount; ++i)
+		{
+			physx::PxBroadPhaseRegion region;
+			region.mBounds = regions[i];
+			region.mUserData = nullptr;
+			mScene->addBroadPhaseRegion(region);
+		}
+	}
+
+	mage_check(settings.ScratchBlockSize % (16 * 1024) == 0);
+
+	if (settings.ScratchBlockSize > 0)
+	{
+		mScratchBlock = mContext.GetAllocator().allocate(settings.ScratchBlockSize, "SimulationScratchBlock", __FILE__, __LINE__);
+		mScratchBlockSize = settings.ScratchBlockSize;
+	}
 }
 
 PhysicsSystem::~PhysicsSystem()
 {
+	EndSimulation();
+	FlushActorChanges();
+
 	PX_RELEASE(mScene);
-	PX_RELEASE(mDispatcher);
-	PX_RELEASE(mPhysics);
-	PX_RELEASE(mFoundation);
+	mContext.GetAllocator().deallocate(mScratchBlock);
 }
 
 void PhysicsSystem::Update(f32 deltaTime)
 {
-	mScene->simulate(deltaTime);
+	BeginSimulation(deltaTime);
+	EndSimulation();
+}
+
+void PhysicsSystem::BeginSimulation(f32 deltaTime)
+{
+	mage_check(!mIsSimulating);
+
+	ExecuteQueries();
+
+	mScene->simulate(deltaTime, nullptr, mScratchBlock, mScratchBlockSize);
+	mIsSimulating = true;
+}
+
+void PhysicsSystem::ExecuteQueries()
+{
+	FlushActorChanges();
+
+	mQueries.Execute(*mScene, mContext.GetDispatcher().GetJobSystem());
+}
+
+void PhysicsSystem::EndSimulation()
+{
+	if (!mIsSimulating)
+		return;
+
+	// Simulation tasks run on the job system, so help with them rather than block.
+	mContext.GetDispatcher().GetJobSystem().WaitUntil([this]() { return mScene->checkResults(false); });
 	mScene->fetchResults(true);
+
+	mIsSimulating = false;
+
+	SyncActiveActors();
+
+	mEventBuffer.Dispatch();
+}
+
+void PhysicsSystem::SyncActiveActors()
+{
+	++mStepIndex;
+
+	physx::PxU32 activeActorCount = 0;
+	physx::PxActor** activeActors = mScene->getActiveActors(activeActorCount);
+
+	for (physx::PxU32 i = 0; i < activeActorCount; ++i)
+	{
+		PhysicsActorListener* listener = static_cast<PhysicsActorListener*>(activeActors[i]->userData);
+		if (listener == nullptr)
+			continue;
+
+		physx::PxRigidDynamic& actor = *static_cast<physx::PxRigidDynamic*>(activeActors[i]);
+
+		listener->mLastMovedStep = mStepIndex;
+		listener->OnPhysicsActorMoved(actor);
+
+		if (listener->mMovingIndex == PhysicsActorListener::cNotMoving)
+			listener->mMovingIndex = mMovingActors.Add(&actor);
+	}
+
+	for (u32 i = 0; i < mMovingActors.GetSize();)
+	{
+		physx::PxRigidDynamic& actor = *mMovingActors[i];
+		PhysicsActorListener& listener = *static_cast<PhysicsActorListener*>(actor.userData);
+
+		if (listener.mLastMovedStep == mStepIndex)
+		{
+			++i;
+			continue;
+		}
+
+		listener.OnPhysicsActorStopped(actor);
+		RemoveMovingActor(listener);
+	}
+}
+
+void PhysicsSystem::RemoveMovingActor(PhysicsActorListener& listener)
+{
+	const u32 index = listener.mMovingIndex;
+	if (index == PhysicsActorListener::cNotMoving)
+		return;
+
+	mMovingActors.RemoveAtSwap(index);
+	if (index < mMovingActors.GetSize())
+		static_cast<PhysicsActorListener*>(mMovingActors[index]->userData)->mMovingIndex = index;
+
+	listener.mMovingIndex = PhysicsActorListener::cNotMoving;
 }
 
 physx::PxRigidActor* PhysicsSystem::AddRigidBody(
 	const PhysicsRigidBodyParams& params,
 	const physx::PxTransform& pose,
 	physx::PxVec3 linearVelocity,
-	physx::PxVec3 angularVelocity)
+	physx::PxVec3 angularVelocity,
+	PhysicsActorListener* listener)
 {
-	physx::PxRigidActor* actor = nullptr;
-	physx::PxMaterial* material = params.Material.get() ? &params.Material->Get() : nullptr;
+	mage_ensure(!mIsSimulating);
 
-	physx::PxShape* shape = mPhysics->createShape(*params.Geometry, &material, true);
-	mage_check(shape);
+	physx::PxRigidActor* actor = nullptr;
+	physx::PxShape* shape = &mContext.GetShapeCache().GetShape(params);
 
 	switch (params.Type)
 	{
 		case PhysicsSystemObjectType::RigidStatic:
 		{
-			physx::PxRigidStatic* rigidStatic = mPhysics->createRigidStatic(pose);
+			physx::PxRigidStatic* rigidStatic = mPhysics.createRigidStatic(pose);
 			rigidStatic->attachShape(*shape);
 
 			actor = rigidStatic;
@@ -53,7 +195,7 @@ physx::PxRigidActor* PhysicsSystem::AddRigidBody(
 
 		case PhysicsSystemObjectType::RigidKinematic:
 		{
-			physx::PxRigidDynamic* rigidDynamic = mPhysics->createRigidDynamic(pose);
+			physx::PxRigidDynamic* rigidDynamic = mPhysics.createRigidDynamic(pose);
 			rigidDynamic->attachShape(*shape);
 			rigidDynamic->setRigidBodyFlag(physx::PxRigidBodyFlag::eKINEMATIC, true);
 
@@ -63,7 +205,7 @@ physx::PxRigidActor* PhysicsSystem::AddRigidBody(
 
 		case PhysicsSystemObjectType::RigidDynamic:
 		{
-			physx::PxRigidDynamic* rigidDynamic = mPhysics->createRigidDynamic(pose);
+			physx::PxRigidDynamic* rigidDynamic = mPhysics.createRigidDynamic(pose);
 			rigidDynamic->attachShape(*shape);
 
 			rigidDynamic->setLinearVelocity(linearVelocity, false);
@@ -76,15 +218,27 @@ physx::PxRigidActor* PhysicsSystem::AddRigidBody(
 
 	mage_check(actor);
 
-	mScene->addActor(*actor);
-	shape->release();
+	actor->userData = listener;
+
+	if (params.Type == PhysicsSystemObjectType::RigidStatic)
+		mPendingStaticActors.Add(actor);
+	else
+		mPendingDynamicActors.Add(actor);
 
 	return actor;
 }
 
+void PhysicsSystem::SetCollisionMatrix(const PhysicsCollisionMatrix& collisionMatrix)
+{
+	mage_check(!mIsSimulating);
+
+	// PhysX keeps its own copy of the shader data.
+	mScene->setFilterShaderData(&collisionMatrix, sizeof(collisionMatrix));
+}
+
 PhysicsSystemMaterialPtr PhysicsSystem::CreateMaterial(const PhysicsSystemMaterialProperties& props)
 {
-	physx::PxMaterial* pxMat = mPhysics->createMaterial(
+	physx::PxMaterial* pxMat = mPhysics.createMaterial(
 		props.StaticFriction,
 		props.DynamicFriction,
 		props.Restitution);
@@ -95,5 +249,65 @@ PhysicsSystemMaterialPtr PhysicsSystem::CreateMaterial(const PhysicsSystemMateri
 void PhysicsSystem::RemoveActor(physx::PxRigidActor* actor)
 {
 	mage_check(actor);
-	mScene->removeActor(*actor);
+	mage_ensure(!mIsSimulating);
+
+	if (PhysicsActorListener* listener = static_cast<PhysicsActorListener*>(actor->userData))
+		RemoveMovingActor(*listener);
+
+	actor->userData = nullptr;
+
+	// Actors which never made it into the scene can go right away.
+	if (actor->getScene() == nullptr)
+	{
+		if (mPendingStaticActors.RemoveSwap(actor) || mPendingDynamicActors.RemoveSwap(actor))
+			actor->release();
+
+		return;
+	}
+
+	mPendingRemovedActors.Add(actor);
+}
+
+void PhysicsSystem::FlushActorChanges()
+{
+	mage_check(!mIsSimulating);
+
+	if (!mPendingRemovedActors.IsEmpty())
+	{
+		// Hits may point at the actors released below.
+		mQueries.DiscardHits();
+
+		mScene->removeActors(mPendingRemovedActors.GetData(), mPendingRemovedActors.GetSize());
+
+		for (physx::PxActor* actor : mPendingRemovedActors)
+			actor->release();
+
+		mPendingRemovedActors.Empty();
+	}
+
+	if (!mPendingStaticActors.IsEmpty())
+	{
+		// Lets the scene take the statics' prebuilt bounds tree as is, instead of inserting each one.
+		physx::PxPruningStructure* pruningStructure = mPendingStaticActors.GetSize() > 1
+			? mPhysics.createPruningStructure(mPendingStaticActors.GetData(), mPendingStaticActors.GetSize())
+			: nullptr;
+
+		if (pruningStructure)
+		{
+			mScene->addActors(*pruningStructure);
+			pruningStructure->release();
+		}
+		else
+		{
+			mScene->addActors(reinterpret_cast<physx::PxActor* const*>(mPendingStaticActors.GetData()), mPendingStaticActors.GetSize());
+		}
+
+		mPendingStaticActors.Empty();
+	}
+
+	if (!mPendingDynamicActors.IsEmpty())
+	{
+		mScene->addActors(reinterpret_cast<physx::PxActor* const*>(mPendingDynamicActors.GetData()), mPendingDynamicActors.GetSize());
+		mPendingDynamicActors.Empty();
+	}
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Physics/PhysicsCommon.h"
+#include "Physics/PhysicsContext.h"
+#include "Physics/PhysicsEventBuffer.h"
+#include "Physics/PhysicsQueryBatch.h"
 
 #include <PxPhysicsAPI.h>
 
@@ -9,29 +12,93 @@ class RigidBodyObjectComponent;
 class PhysicsSystem : public NonCopyableClass
 {
 public:
-	PhysicsSystem();
+	// Adds a scene to a context shared with other systems, which must outlive this one.
+	PhysicsSystem(PhysicsContext& context, const PhysicsSystemSettings& settings = {});
+
+	// Creates a context of its own, for when this is the only system in the process.
+	PhysicsSystem(mage::JobSystem& jobSystem, const PhysicsSystemSettings& settings = {});
 
 	~PhysicsSystem();
 
 	void Update(f32 deltaTime);
 
+	// Starts a step which runs on the job system until EndSimulation. Actors must not be added or
+	// removed in between.
+	void BeginSimulation(f32 deltaTime);
+
+	// Waits for the step started by BeginSimulation, helping with its tasks, and fetches its results.
+	void EndSimulation();
+
+	bool IsSimulating() const { return mIsSimulating; }
+
+	// Creates the actor right away, but only inserts it into the scene with the next batch of actor
+	// changes, so it is not part of the simulation or scene queries until then. Not while simulating.
 	physx::PxRigidActor* AddRigidBody(
 		const PhysicsRigidBodyParams& params,
 		const physx::PxTransform& pose,
 		physx::PxVec3 linearVelocity,
-		physx::PxVec3 angularVelocity);
+		physx::PxVec3 angularVelocity,
+		PhysicsActorListener* listener = nullptr);
+
+	// Pairs which are already touching keep interacting until they separate.
+	void SetCollisionMatrix(const PhysicsCollisionMatrix& collisionMatrix);
 
 	PhysicsSystemMaterialPtr CreateMaterial(const PhysicsSystemMaterialProperties& props);
 
+	// Turns StaticMesh data into geometries for PhysicsRigidBodyParams.
+	PhysicsMeshCooker& GetMeshCooker() { return mContext.GetMeshCooker(); }
+
+	// Where PhysX memory goes, for every system on the same context.
+	const PhysicsAllocator& GetAllocator() const { return mContext.GetAllocator(); }
+
+	PhysicsContext& GetContext() const { return mContext; }
+
+	// Queues the actor for removal with the next batch of actor changes, after which it is released.
+	// Not while simulating, as it also drops the actor from the moving set which EndSimulation walks.
 	void RemoveActor(physx::PxRigidActor* actor);
 
+	// Queries added during an update run together right before the next simulation step, against
+	// the scene as the previous step left it. Their hits stay available until the step after, unless
+	// FlushActorChanges is called in between and releases removed actors.
+	PhysicsQueryBatch& GetQueries() { return mQueries; }
+
+	// Runs the queries added so far right away instead of waiting for the next step.
+	void ExecuteQueries();
+
+	// Applies queued actor insertions and removals with one scene call each. Queued static actors are
+	// inserted through a pruning structure. Runs automatically before each simulation step.
+	void FlushActorChanges();
+
 private:
-	physx::PxDefaultAllocator mAllocator;
-	physx::PxDefaultErrorCallback mErrorCallback;
-	physx::PxFoundation* mFoundation = nullptr;
-	physx::PxPhysics* mPhysics = nullptr;
-	physx::PxDefaultCpuDispatcher* mDispatcher = nullptr;
+	std::unique_ptr<PhysicsContext> mOwnedContext;
+	PhysicsContext& mContext;
+	physx::PxPhysics& mPhysics;
 	physx::PxScene* mScene = nullptr;
+
+	// Handed to every simulate call for the step's temporary data.
+	void* mScratchBlock = nullptr;
+	u32 mScratchBlockSize = 0;
+
+	PhysicsQueryBatch mQueries;
+
+	PhysicsEventBuffer mEventBuffer;
+
+	bool mIsSimulating = false;
+
+	mage::Array<physx::PxRigidActor*> mPendingStaticActors;
+	mage::Array<physx::PxRigidActor*> mPendingDynamicActors;
+	mage::Array<physx::PxActor*> mPendingRemovedActors;
+
+	// Listened actors which moved in the last step, to tell their listeners when they stop.
+	mage::Array<physx::PxRigidDynamic*> mMovingActors;
+	u64 mStepIndex = 0;
+
+	PhysicsSystem(std::unique_ptr<PhysicsContext>&& ownedContext, const PhysicsSystemSettings& settings);
+
+	void CreateScene(const PhysicsSystemSettings& settings);
+
+	void SyncActiveActors();
+	void RemoveMovingActor(PhysicsActorListener& listener);
 };
 
 struct PhysicsSystemMaterial : public NonCopyableStruct
@@ -43,6 +110,11 @@ struct PhysicsSystemMaterial : public NonCopyableStruct
 
 	physx::PxMaterial& Get() { return mMaterial; }
 
+	PhysicsSystemMaterialProperties GetProperties() const
+	{
+		return { mMaterial.getStaticFriction(), mMaterial.getDynamicFriction(), mMaterial.getRestitution() };
+	}
+
 private:
 	PhysicsSystem& mSystem;
 	physx::PxMaterial& mMaterial;
@@ -2,9 +2,11 @@
 #include "Game/InputSystem.h"
 #include "Game/RigidBodyObjectComponent.h"
 #include "Game/StaticMeshObjectComponent.h"
+#include "Game/WorldSnapshot.h"
 #include "Physics/PhysicsCommon.h"
 #include "Utility/BallSpawnerComponent.h"
-#include "Utility/KillZObjectComponent.h"
+
+static const bool sIsSnapshotRegistered = WorldSnapshot::RegisterComponentClass<BallSpawnerComponent>();
 
 BallSpawnerComponent::BallSpawnerComponent(TransformableObject& owner, const ComponentTemplate<BallSpawnerComponent>& creationTemplate) :
 	GameObjectComponent(owner),
@@ -48,9 +50,28 @@ void BallSpawnerComponent::SpawnBall()
 	staticMeshTemplate.Texture = mTexture;
 	GameObject::CreateComponent(ball, staticMeshTemplate);
 
-	ComponentTemplate<KillZObjectComponent> killZTemplate;
-	killZTemplate.KillZ = -10.0f;
-	GameObject::CreateComponent(ball, killZTemplate);
-
 	mOwner.GetWorld()->AddObject(ballPtr);
 }
+
+void BallSpawnerComponent::SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const
+{
+	data.RigidBody = writer.AddRigidBodyParams(mRigidBodyParams);
+	data.Mesh = writer.AddAsset(mMesh);
+	data.Texture = writer.AddAsset(mTexture);
+	data.Speed = mSpeed;
+	data.InputSpawn = mInputSpawn;
+	data.PendingBallSpawn = mPendingBallSpawn;
+}
+
+void BallSpawnerComponent::LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader)
+{
+	ComponentTemplate<BallSpawnerComponent> creationTemplate;
+	creationTemplate.RigidBodyParams = reader.GetRigidBodyParams(data.RigidBody);
+	creationTemplate.Mesh = reader.GetAsset<StaticMesh>(data.Mesh);
+	creationTemplate.Texture = reader.GetAsset<Texture>(data.Texture);
+	creationTemplate.Speed = data.Speed;
+	creationTemplate.InputSpawn = data.InputSpawn;
+
+	BallSpawnerComponent& component = GameObject::CreateComponent(owner, creationTemplate);
+	component.mPendingBallSpawn = data.PendingBallSpawn;
+}
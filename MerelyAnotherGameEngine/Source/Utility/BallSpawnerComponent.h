@@ -17,9 +17,34 @@ struct ComponentTemplate<class BallSpawnerComponent>
 
 class BallSpawnerComponent : public GameObjectComponent<TransformableObject>
 {
+	friend GameObject;
+
 public:
 	BallSpawnerComponent(TransformableObject& owner, const ComponentTemplate<BallSpawnerComponent>& creationTemplate);
 
+	static constexpr cstr cSnapshotName = "BallSpawner";
+
+	struct SnapshotData
+	{
+		u32 RigidBody;
+		u32 Mesh;
+		u32 Texture;
+		f32 Speed;
+		i32 InputSpawn;
+		bool PendingBallSpawn;
+	};
+
+	void SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const;
+	static void LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader);
+
+	struct RollbackState
+	{
+		bool PendingBallSpawn;
+	};
+
+	void SaveRollbackState(RollbackState& state) const { state.PendingBallSpawn = mPendingBallSpawn; }
+	void RestoreRollbackState(const RollbackState& state) { mPendingBallSpawn = state.PendingBallSpawn; }
+
 protected:
 	virtual void OnOwnerAddedToWorld(GameWorld& world) override final;
 
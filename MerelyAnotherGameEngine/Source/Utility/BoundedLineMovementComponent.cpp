@@ -1,7 +1,10 @@
 #include "Game/GameWorld.h"
 #include "Game/InputSystem.h"
+#include "Game/WorldSnapshot.h"
 #include "Utility/BoundedLineMovementComponent.h"
 
+static const bool sIsSnapshotRegistered = WorldSnapshot::RegisterComponentClass<BoundedLineMovementComponent>();
+
 BoundedLineMovementComponent::BoundedLineMovementComponent(TransformableObject& owner, const ComponentTemplate<BoundedLineMovementComponent>& creationTemplate) :
 	GameObjectComponent(owner),
 	mExtent(creationTemplate.Extent),
@@ -80,5 +83,54 @@ void BoundedLineMovementComponent::UpdatePrePhysics(f32 deltaTime)
 		mSpeed = 0.0f;
 	}
 
+	// Kinematic bodies are not moved back from physics, so the step to interpolate over starts here.
+	mOwner.PreviousTransform = mOwner.Transform;
 	mOwner.Transform.Position = mCenter + mPosition / mLength * mExtent;
 }
+
+void BoundedLineMovementComponent::SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const
+{
+	data.Center = mCenter;
+	data.Extent = mExtent;
+	data.InputNeg = mInputNeg;
+	data.InputPos = mInputPos;
+	data.Acceleration = mAcceleration;
+	data.Deceleration = mDeceleration;
+	data.MaxSpeed = mMaxSpeed;
+	data.Speed = mSpeed;
+	data.Position = mPosition;
+}
+
+void BoundedLineMovementComponent::LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader)
+{
+	ComponentTemplate<BoundedLineMovementComponent> creationTemplate;
+	creationTemplate.Extent = data.Extent;
+	creationTemplate.InputNeg = data.InputNeg;
+	creationTemplate.InputPos = data.InputPos;
+	creationTemplate.Acceleration = data.Acceleration;
+	creationTemplate.Deceleration = data.Deceleration;
+	creationTemplate.MaxSpeed = data.MaxSpeed;
+	GameObject::CreateComponent(owner, creationTemplate);
+}
+
+void BoundedLineMovementComponent::RestoreSnapshot(const SnapshotData& data)
+{
+	// Joining the world took the owner's position, which has since moved along the line, as the center.
+	mCenter = data.Center;
+	mSpeed = data.Speed;
+	mPosition = data.Position;
+}
+
+void BoundedLineMovementComponent::SaveRollbackState(RollbackState& state) const
+{
+	state.Center = mCenter;
+	state.Speed = mSpeed;
+	state.Position = mPosition;
+}
+
+void BoundedLineMovementComponent::RestoreRollbackState(const RollbackState& state)
+{
+	mCenter = state.Center;
+	mSpeed = state.Speed;
+	mPosition = state.Position;
+}
@@ -21,9 +21,42 @@ struct ComponentTemplate<class BoundedLineMovementComponent>
 
 class BoundedLineMovementComponent : public GameObjectComponent<TransformableObject>
 {
+	friend GameObject;
+
 public:
+	static constexpr ComponentUpdateAccess cUpdateAccess = ComponentUpdateAccess::OwnerOnly;
+
 	BoundedLineMovementComponent(TransformableObject& owner, const ComponentTemplate<BoundedLineMovementComponent>& creationTemplate);
 
+	static constexpr cstr cSnapshotName = "BoundedLineMovement";
+
+	struct SnapshotData
+	{
+		glm::vec3 Center;
+		glm::vec3 Extent;
+		i32 InputNeg;
+		i32 InputPos;
+		f32 Acceleration;
+		f32 Deceleration;
+		f32 MaxSpeed;
+		f32 Speed;
+		f32 Position;
+	};
+
+	void SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const;
+	static void LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader);
+	void RestoreSnapshot(const SnapshotData& data);
+
+	struct RollbackState
+	{
+		glm::vec3 Center;
+		f32 Speed;
+		f32 Position;
+	};
+
+	void SaveRollbackState(RollbackState& state) const;
+	void RestoreRollbackState(const RollbackState& state);
+
 protected:
 	virtual void OnOwnerAddedToWorld(GameWorld& world) override final;
 
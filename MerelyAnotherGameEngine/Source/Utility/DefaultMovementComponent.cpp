@@ -1,7 +1,10 @@
 #include "Game/GameWorld.h"
 #include "Game/InputSystem.h"
+#include "Game/WorldSnapshot.h"
 #include "Utility/DefaultMovementComponent.h"
 
+static const bool sIsSnapshotRegistered = WorldSnapshot::RegisterComponentClass<DefaultMovementComponent>();
+
 DefaultMovementComponent::DefaultMovementComponent(TransformableObject& owner, const ComponentTemplate<DefaultMovementComponent>& creationTemplate) :
 	GameObjectComponent(owner),
 	mInputR(creationTemplate.InputR),
@@ -25,6 +28,8 @@ void DefaultMovementComponent::UpdatePrePhysics(f32 deltaTime)
 	glm::vec3 movement(0.0f);
 	InputSystem& inputSystem = mOwner.GetWorld()->GetInputSystem();
 
+	mOwner.PreviousTransform = mOwner.Transform;
+
 	mRotation += 0.01f * glm::vec2(mCursorMovement);
 	mRotation.y = glm::clamp(mRotation.y, -glm::radians(80.0f), glm::radians(80.0f));
 	mCursorMovement = glm::dvec2(0.0f);
@@ -46,3 +51,42 @@ void DefaultMovementComponent::UpdatePrePhysics(f32 deltaTime)
 
 	mOwner.Transform.Position += mSpeed * deltaTime * movement;
 }
+
+void DefaultMovementComponent::SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const
+{
+	data.InputR = mInputR;
+	data.InputL = mInputL;
+	data.InputF = mInputF;
+	data.InputB = mInputB;
+	data.InputU = mInputU;
+	data.InputD = mInputD;
+	data.Speed = mSpeed;
+	data.Rotation = mRotation;
+}
+
+void DefaultMovementComponent::LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader)
+{
+	ComponentTemplate<DefaultMovementComponent> creationTemplate;
+	creationTemplate.InputR = data.InputR;
+	creationTemplate.InputL = data.InputL;
+	creationTemplate.InputF = data.InputF;
+	creationTemplate.InputB = data.InputB;
+	creationTemplate.InputU = data.InputU;
+	creationTemplate.InputD = data.InputD;
+	creationTemplate.Speed = data.Speed;
+
+	DefaultMovementComponent& component = GameObject::CreateComponent(owner, creationTemplate);
+	component.mRotation = data.Rotation;
+}
+
+void DefaultMovementComponent::SaveRollbackState(RollbackState& state) const
+{
+	state.CursorMovement = mCursorMovement;
+	state.Rotation = mRotation;
+}
+
+void DefaultMovementComponent::RestoreRollbackState(const RollbackState& state)
+{
+	mCursorMovement = state.CursorMovement;
+	mRotation = state.Rotation;
+}
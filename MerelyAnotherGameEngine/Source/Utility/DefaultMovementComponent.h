@@ -21,9 +21,39 @@ struct ComponentTemplate<class DefaultMovementComponent>
 
 class DefaultMovementComponent : public GameObjectComponent<TransformableObject>
 {
+	friend GameObject;
+
 public:
+	static constexpr ComponentUpdateAccess cUpdateAccess = ComponentUpdateAccess::OwnerOnly;
+
 	DefaultMovementComponent(TransformableObject& owner, const ComponentTemplate<DefaultMovementComponent>& creationTemplate);
 
+	static constexpr cstr cSnapshotName = "DefaultMovement";
+
+	struct SnapshotData
+	{
+		i32 InputR;
+		i32 InputL;
+		i32 InputF;
+		i32 InputB;
+		i32 InputU;
+		i32 InputD;
+		f32 Speed;
+		glm::vec2 Rotation;
+	};
+
+	void SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const;
+	static void LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader);
+
+	struct RollbackState
+	{
+		glm::dvec2 CursorMovement;
+		glm::vec2 Rotation;
+	};
+
+	void SaveRollbackState(RollbackState& state) const;
+	void RestoreRollbackState(const RollbackState& state);
+
 protected:
 	virtual void OnOwnerAddedToWorld(GameWorld& world) override final;
 
@@ -1,16 +1,27 @@
 #include "Game/GameWorld.h"
+#include "Game/WorldSnapshot.h"
 #include "Utility/KillZObjectComponent.h"
 
+static const bool sIsSnapshotRegistered = WorldSnapshot::RegisterComponentClass<KillZObjectComponent>();
+
 KillZObjectComponent::KillZObjectComponent(TransformableObject& owner, const ComponentTemplate<KillZObjectComponent>& creationTemplate) :
-	GameObjectComponent(owner),
-	mKillZ(creationTemplate.KillZ)
+	GameObjectComponent(owner)
 {
 }
 
-void KillZObjectComponent::UpdatePostPhysics(f32 deltaTime)
+void KillZObjectComponent::OnOwnerTrigger(const TriggerEvent& event)
 {
-	if (mOwner.Transform.Position.z < mKillZ)
+	if (event.Type == TriggerEventType::Enter && event.IsOwnTrigger && event.Other)
 	{
-		mOwner.Destroy();
+		event.Other->Destroy();
 	}
 }
+
+void KillZObjectComponent::SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const
+{
+}
+
+void KillZObjectComponent::LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader)
+{
+	GameObject::CreateComponent(owner, ComponentTemplate<KillZObjectComponent>());
+}
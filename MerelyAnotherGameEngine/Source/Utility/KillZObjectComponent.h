@@ -6,17 +6,22 @@
 template<>
 struct ComponentTemplate<class KillZObjectComponent>
 {
-	f32 KillZ = 0.0f;
 };
 
+// Destroys every object which enters its owner's trigger, such as a slab below the arena which
+// catches whatever falls off it. Objects without a rigid body never reach it.
 class KillZObjectComponent : public GameObjectComponent<TransformableObject>
 {
 public:
 	KillZObjectComponent(TransformableObject& owner, const ComponentTemplate<KillZObjectComponent>& creationTemplate);
 
-protected:
-	virtual void UpdatePostPhysics(f32 deltaTime) override final;
+	static constexpr cstr cSnapshotName = "KillZ";
+
+	struct SnapshotData {};
 
-private:
-	f32 mKillZ;
+	void SaveSnapshot(SnapshotData& data, WorldSnapshotWriter& writer) const;
+	static void LoadSnapshot(TransformableObject& owner, const SnapshotData& data, WorldSnapshotReader& reader);
+
+protected:
+	virtual void OnOwnerTrigger(const TriggerEvent& event) override;
 };